@@ -0,0 +1,136 @@
+/*
+ * arena.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the DSP state arena and the audio path
+ * allocation tracker.
+ *
+ * NOTE: Every RtUserData owns an Arena. initData runs inside an ArenaScope,
+ * so every ArenaVector it sizes (delay and reverb lines, convolver spectra,
+ * oversampler states, graph buffers) is carved out of that one region
+ * instead of the heap:
+ *   - the address space is reserved once, by the first initData: a
+ *     throwaway state is built first with a measuring arena, and what it
+ *     would have taken plus ARENA_SLACK is reserved (no memory behind it).
+ *     It is committed in ARENA_COMMIT steps as allocations reach it, so the
+ *     arena never moves and is sized by what the stream actually needs.
+ *     Keeping the reservation tight matters under mlockall, which counts
+ *     reserved address space against RLIMIT_MEMLOCK
+ *   - allocations are cache line aligned; those of a huge page or more
+ *     (long delay lines at high rates, convolver spectra) start on a huge
+ *     page boundary, and the region is advised for transparent huge pages
+ *   - nothing is freed: a vector released by the arena's owner is simply
+ *     dropped, and initData at the same format resizes vectors in place,
+ *     so returning to the menu and streaming again allocates nothing
+ * An ArenaVector sized outside any scope, or that does not fit, uses the
+ * heap as usual.
+ *
+ * The tracker counts operator new calls made by threads while they are on
+ * the audio path (inside an AudioPathScope: processBlock, the graph and
+ * engine workers). render and bench exit with an error if it is not zero.
+ *
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#define ARENA_COMMIT    (2ul << 20)     // commit step (one huge page)
+#define ARENA_SLACK     ARENA_COMMIT    // reserved beyond the measured size (engine period buffers)
+#define ARENA_ALIGN     64              // cache line
+#define ARENA_HUGE_PAGE (2ul << 20)     // allocations this big start on a huge page
+
+// One region of DSP state
+struct Arena{
+    unsigned char* base = nullptr;
+    size_t reserved  = 0;           // address space
+    size_t committed = 0;           // usable bytes
+    size_t used      = 0;
+    bool   measuring = false;       // only count what would be allocated (sizing pass)
+
+    Arena() {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    ~Arena();
+};
+
+// Reserve bytes of address space for the arena (done once, by initData).
+// Returns 0 on success, or prints the reason and returns -1 (the arena's
+// allocations then come from the heap).
+int arenaInit(Arena &arena, size_t bytes);
+
+// Carve bytes out of the arena (aligned, see above). Returns NULL if it is
+// full or not reserved; a measuring arena counts the bytes and returns NULL.
+void* arenaAlloc(Arena &arena, size_t bytes);
+
+// Whether a pointer lies inside any live arena
+bool arenaOwns(const void* p);
+
+// Route ArenaVector allocations of the calling thread into an arena
+// while in scope (if it is reserved or measuring)
+class ArenaScope{
+public:
+    explicit ArenaScope(Arena &arena);
+    ~ArenaScope();
+private:
+    Arena* previous;
+};
+
+// Arena of the calling thread's innermost ArenaScope (NULL if none)
+Arena* currentArena();
+
+// Allocator of ArenaVector: the current arena, or the heap outside a scope
+template <typename T>
+struct ArenaAllocator{
+    typedef T value_type;
+
+    ArenaAllocator() {}
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>&) {}
+
+    T* allocate(size_t count){
+        Arena* arena = currentArena();
+        if (arena){
+            void* p = arenaAlloc(*arena, count * sizeof(T));
+            if (p) return (T*)p;
+        }
+        return (T*)::operator new(count * sizeof(T));
+    }
+
+    void deallocate(T* p, size_t){
+        if (!arenaOwns(p)) ::operator delete(p);
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return true; }
+template <typename T, typename U>
+inline bool operator!=(const ArenaAllocator<T>&, const ArenaAllocator<U>&) { return false; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T> >;
+
+// Base of structs with cache line aligned members (RtUserData and what
+// holds one): new in C++11 only guarantees alignof(max_align_t)
+struct CacheAligned{
+    static void* operator new(size_t bytes);
+    static void  operator delete(void* p);
+};
+
+
+// --- Allocation tracker ---
+
+// Marks the calling thread as being on the audio path while in scope
+class AudioPathScope{
+public:
+    AudioPathScope();
+    ~AudioPathScope();
+};
+
+// Heap allocations made on the audio path so far (all threads)
+unsigned long audioPathAllocations();
+unsigned long audioPathAllocatedBytes();
@@ -13,7 +13,25 @@
 #include "types.h"
 #define SAMPLE_SILENCE 0.0f
 
-float applyToneFilter(SAMPLE inputSample, RtUserData *ud, SAMPLE* filterBuffer, float toneAmount);
+// Filter kernels
+void applyToneFilter(float* block, unsigned long frames, RtUserData *ud, FirState &filterState, float toneAmount);
+void applyDCFilter(float* block, unsigned long frames, RtUserData *ud, int channel);
+
+
+// Effects (whole block, one float buffer per channel)
+void processTremolo(float* const* block, unsigned long frames, RtUserData* ud);
+void processDelay(float* const* block, unsigned long frames, RtUserData* ud);
+void processReverb(float* const* block, unsigned long frames, RtUserData* ud);
+void processBitcrush(float* const* block, unsigned long frames, RtUserData* ud);
+void processOverdrive(float* const* block, unsigned long frames, RtUserData* ud);
+void processDistortion(float* const* block, unsigned long frames, RtUserData* ud);
+void processFuzz(float* const* block, unsigned long frames, RtUserData* ud);
+void processCabinet(float* const* block, unsigned long frames, RtUserData* ud);
+void processPhaser(float* const* block, unsigned long frames, RtUserData* ud);
+void processChorus(float* const* block, unsigned long frames, RtUserData* ud);
+void processFlanger(float* const* block, unsigned long frames, RtUserData* ud);
+void processVibrato(float* const* block, unsigned long frames, RtUserData* ud);
+void processMultitap(float* const* block, unsigned long frames, RtUserData* ud);
 
 
 inline float toFloat(SAMPLE val){
@@ -26,6 +44,7 @@ inline SAMPLE toSample(float val){
 	return (SAMPLE)(val * 32767.0f);
 }
 
-void processBlock(const SAMPLE* in, SAMPLE* out,
+// in/out are interleaved frames of params->CHANNELS channels in params->FORMAT
+void processBlock(const void* in, void* out,
                 unsigned long framesPerBuffer,
                 RtUserData* ud);
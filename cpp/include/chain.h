@@ -0,0 +1,38 @@
+/*
+ * chain.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the effect chain. The chain is an ordered
+ * list of effect nodes resolved from EffectChoices once per block; each
+ * node processes the whole block before the next one runs.
+ *
+*/
+
+#pragma once
+
+#include "types.h"
+
+struct EffectNode{
+    EffectType    type;
+    EffectProcess process;
+};
+
+struct EffectChain{
+    EffectNode nodes[EffectChoices::MAX_CHAIN];
+    int length = 0;
+};
+
+// Name of an effect (for printing)
+const char* effectName(EffectType type);
+
+// Processing function of an effect (NULL for pass through)
+EffectProcess effectProcess(EffectType type);
+
+// Build the chain from the user's choices
+void buildChain(const EffectChoices &effectChoice, EffectChain &chain);
+
+// Run every node of the chain over a block
+void runChain(const EffectChain &chain, float* const* block, unsigned long frames, RtUserData* ud);
@@ -0,0 +1,72 @@
+/*
+ * control.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of live parameter control. A control thread
+ * pushes commands into RtUserData::commands (lock free, single producer /
+ * single consumer); processBlock applies them at the start of each block
+ * and ramps changed parameters over SMOOTH_MS to avoid zipper noise.
+ *
+*/
+
+#pragma once
+
+#include <string>
+#include "types.h"
+
+#define SMOOTH_MS     20        // ramp time of a parameter change
+#define SMOOTH_FRAMES 32        // sub-block size while a ramp is running
+
+// --- Control side ---
+
+// Queue a parameter change. Drive, factor and bias changes of overdrive /
+// fuzz also build new waveshaper tables here, on the calling thread (when
+// SHAPER_TABLES is on), and are queued together with them or not at all.
+// Returns false (and says why) if the queue is full or no table slot is free.
+bool sendParam(RtUserData &ud, ParamId param, float value);
+
+// Queue a new effect chain (returns false if the queue is full)
+bool sendChain(RtUserData &ud, const EffectChoices &effectChoice);
+
+// Queue a new multi-tap delay pattern (returns false if the queue is full)
+bool sendTaps(RtUserData &ud, const TapPattern &pattern);
+
+// Compile a routing (graph.h) on the calling thread and queue it (returns
+// false and prints the reason if it is not valid or the queue is full)
+bool sendGraph(RtUserData &ud, const std::string &spec);
+
+// Prepare a preset's graph and waveshaper tables on the calling thread and
+// queue the whole preset as one command (returns false and prints the
+// reason if a slot or the queue is full). The preset must outlive streaming.
+bool sendPreset(RtUserData &ud, const Preset &preset);
+
+// Parse and queue a text command: "<param> <value>", "chain <menu keys>",
+// "graph <routing>", "taps <pattern>" or "preset <name>".
+// Returns false and prints the reason if the command is not valid.
+bool sendControlLine(RtUserData &ud, const std::string &line);
+
+// Print the commands accepted by sendControlLine
+void printControlHelp();
+
+// Parameter names ("mix", "od_drive", ...) and lookup (NUM_PARAMS if unknown)
+const char* paramName(ParamId param);
+ParamId paramByName(const std::string &name);
+
+// Set a parameter straight away, clamped to its range (before initData)
+void paramSet(AudioParams &audioParams, ParamId param, float value);
+
+// --- Audio side (no locks, no allocation) ---
+
+// Copy the parameters from ud->params into the effects' state blocks
+// (types.h), working out what is derived from them. initData takes the
+// first snapshot; advanceRamps takes one after moving any parameter.
+void snapshotParams(RtUserData* ud);
+
+// Apply queued commands
+void applyControl(RtUserData* ud);
+
+// Move running ramps on by a number of frames
+void advanceRamps(RtUserData* ud, unsigned long frames);
@@ -0,0 +1,78 @@
+/*
+ * conv.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the convolution engine used by the cabinet
+ * effect (cabinet / room impulse responses loaded from WAV files).
+ *
+ * NOTE: The first CONV_PARTITION taps of the impulse response run as a
+ * direct FIR (fir.h), so the effect adds no latency. The rest is split into
+ * uniform partitions of CONV_PARTITION taps and convolved with overlap-save
+ * FFTs: every CONV_PARTITION input frames one forward FFT goes into a
+ * frequency-domain delay line, it is multiplied with every partition's
+ * spectrum, and one inverse FFT gives the next CONV_PARTITION output
+ * frames. That output is already delayed by one partition, which is exactly
+ * where the tail starts.
+ *
+*/
+
+#pragma once
+
+#include <vector>
+#include "arena.h"
+#include "fft.h"
+#include "fir.h"
+
+#define CONV_PARTITION   128        // frames per partition and FIR head length (<= MAX_FIR_TAPS)
+#define CONV_MAX_SECONDS 10         // longer impulse responses are cut
+
+// Impulse response as loaded (interleaved)
+struct ImpulseResponse{
+    std::vector<float> samples;
+    int channels   = 0;
+    int sampleRate = 0;
+};
+
+// One channel of a prepared impulse response
+struct ConvFilter{
+    FirCoefficients head;           // first CONV_PARTITION taps
+    int partitions = 0;             // tail partitions
+    ArenaVector<float> re, im;      // partitions * (CONV_PARTITION + 1) bins
+};
+
+// One channel of convolution state
+struct ConvState{
+    FirState head;
+    ArenaVector<float> delayRe, delayIm;        // frequency-domain delay line
+    int   delayIndex = 0;                       // newest spectrum
+    float window[2 * CONV_PARTITION] = {};      // previous + current input partition
+    float output[CONV_PARTITION] = {};          // tail output being played out
+    int   position = 0;                         // frames into the current partition
+};
+
+// Prepared impulse response, state per stream channel and scratch
+struct Convolver{
+    FftPlan plan;                   // 2 * CONV_PARTITION
+    ArenaVector<ConvFilter> filters;    // one per impulse response channel
+    ArenaVector<ConvState>  states;     // one per stream channel
+    ArenaVector<float> accRe, accIm, time;
+};
+
+// Read an impulse response from a 16-bit PCM WAV. Returns 0 on success.
+int loadImpulseResponse(const char* path, ImpulseResponse &ir);
+
+// Prepare an impulse response for a stream (resampled to sampleRate,
+// normalized to unit energy) and clear the state. An empty impulse
+// response leaves the convolver empty. Allocates.
+void convolverInit(Convolver &conv, const ImpulseResponse &ir, int sampleRate, int channels);
+
+// Clear the state
+void convolverReset(Convolver &conv);
+
+// Convolve one channel: out = ir * in (in and out must not overlap).
+// Stream channel c uses impulse response channel c % ir channels.
+void convolverProcess(Convolver &conv, int channel, const float* in, float* out,
+                      unsigned long frames);
@@ -0,0 +1,55 @@
+/*
+ * convert.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of block sample <-> float conversion. Whole blocks
+ * of interleaved S16 frames are converted to one float buffer per channel
+ * and back (with saturation). SSE2/AVX2 or NEON kernels are picked at
+ * startup; the scalar versions are the reference they must match exactly.
+ *
+*/
+
+#pragma once
+
+#include "types.h"
+
+// Interleaved S16 -> one float buffer per channel (x / 32768)
+void deinterleaveToFloat(const SAMPLE* in, float* const* out, unsigned long frames, int channels);
+
+// One float buffer per channel -> interleaved S16 (clamped to [-1, 1], x * 32767, truncated)
+void interleaveToSample(const float* const* in, SAMPLE* out, unsigned long frames, int channels);
+
+// Scalar reference versions (built from toFloat / toSample)
+void deinterleaveToFloatScalar(const SAMPLE* in, float* const* out, unsigned long frames, int channels);
+void interleaveToSampleScalar(const float* const* in, SAMPLE* out, unsigned long frames, int channels);
+
+// Interleaved frames of any SampleFormat <-> one float buffer per channel.
+// S16 goes through the kernels above; S24/S32/FLOAT use plain loops
+// (S24/S32 scale by 2^-23 / 2^-31 and clamp + truncate on the way back,
+// FLOAT is only clamped).
+void deinterleaveFrames(const void* in, SampleFormat format, float* const* out,
+                        unsigned long frames, int channels);
+void interleaveFrames(const float* const* in, void* out, SampleFormat format,
+                      unsigned long frames, int channels);
+
+// Name of the kernel set selected at startup ("avx2", "sse2", "neon" or "scalar")
+const char* convertKernelName();
+
+// One set of S16 <-> float kernels
+typedef void (*DeinterleaveFunc)(const SAMPLE*, float* const*, unsigned long, int);
+typedef void (*InterleaveFunc)(const float* const*, SAMPLE*, unsigned long, int);
+
+struct ConvertKernels{
+    const char*      name;
+    DeinterleaveFunc toFloat;
+    InterleaveFunc   toSample;
+};
+
+// Every kernel set this CPU can run, best first and scalar last; the first
+// is the one selected at startup. For checking each against the scalar
+// reference.
+int convertKernelCount();
+const ConvertKernels &convertKernel(int index);
@@ -0,0 +1,43 @@
+/*
+ * cpu.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the CPU feature checks the SIMD kernels are
+ * picked by. Each engine lists its kernels best first with the feature
+ * they need, ending with the scalar one, and cpuSelect picks the first
+ * the CPU can run.
+ *
+*/
+
+#pragma once
+
+// Instruction set a kernel needs
+enum CpuFeature{
+    CPU_ANY,            // plain C++ (the scalar kernels)
+    CPU_SSE,
+    CPU_SSE2,
+    CPU_AVX,
+    CPU_AVX2,
+    CPU_NEON            // only listed in builds with __ARM_NEON
+};
+
+// A kernel (or set of kernels) and what it needs
+template <typename Kernel>
+struct CpuChoice{
+    CpuFeature needs;
+    Kernel     kernel;
+};
+
+// Whether this CPU runs code built for a feature
+bool cpuSupports(CpuFeature feature);
+
+// First choice the CPU supports (the last one, scalar, always is)
+template <typename Kernel>
+const Kernel &cpuSelect(const CpuChoice<Kernel>* choices, int count){
+    for (int i = 0; i < count - 1; i++)
+        if (cpuSupports(choices[i].needs)) return choices[i].kernel;
+    return choices[count - 1].kernel;
+}
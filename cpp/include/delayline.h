@@ -0,0 +1,122 @@
+/*
+ * delayline.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the delay line used by the delay and the
+ * modulation effects (chorus, flanger, vibrato).
+ *
+ * NOTE: The capacity is a power of two, so every access wraps with a mask
+ * and no loop needs a wrap branch. Reads take a distance in samples that
+ * may be fractional; the interpolation is a template parameter so each
+ * effect gets its own loop without a per-sample switch:
+ *   DELAY_LINEAR    two points, cheapest, dulls the highs when modulated
+ *   DELAY_ALLPASS   first order allpass, flat magnitude, for distances
+ *                   that change slowly (one sample of state per tap)
+ *   DELAY_LAGRANGE  four point (3rd order) Lagrange, for modulated reads
+ * A whole number distance reads that sample unchanged with every method.
+ *
+ * Distances count back from the write position: the last sample written
+ * is 1 back. Reading before writing a sample therefore gives a delay equal
+ * to the distance; after delayWriteBlock, frame i of the block is
+ * (frames - i) back (see delayReadBlock).
+ *
+*/
+
+#pragma once
+
+#include "arena.h"
+
+enum DelayInterp{
+    DELAY_LINEAR,
+    DELAY_ALLPASS,
+    DELAY_LAGRANGE
+};
+
+// One channel of delay
+struct DelayLine{
+    ArenaVector<float> buffer;
+    unsigned mask  = 0;             // capacity - 1
+    unsigned index = 0;             // next write position
+};
+
+// State of one read tap (only allpass reads use it)
+struct DelayTap{
+    float allpass = 0.0f;           // previous output
+};
+
+
+// Allocate room for distances up to maxDistance (plus the interpolation
+// points) and clear the line
+void delayInit(DelayLine &line, unsigned maxDistance);
+
+// Clear the line (and keep its capacity)
+void delayReset(DelayLine &line);
+
+// Append one sample
+inline void delayWrite(DelayLine &line, float x){
+    line.buffer[line.index] = x;
+    line.index = (line.index + 1) & line.mask;
+}
+
+// Append a block
+void delayWriteBlock(DelayLine &line, const float* in, unsigned long frames);
+
+// Sample a whole number of samples back (distance >= 1)
+inline float delayTap(const DelayLine &line, unsigned distance){
+    return line.buffer[(line.index - distance) & line.mask];
+}
+
+// Whole number reads for the next frames writes: out[i] is what
+// delayTap(line, distance) returns just before the i-th of them. Needs
+// distance >= frames (all of it already written).
+void delayCopy(const DelayLine &line, unsigned distance, float* out, unsigned long frames);
+
+// Sample a fractional distance back. Needs distance >= 1 for linear,
+// >= 1.5 for allpass and >= 2 for Lagrange.
+template <DelayInterp INTERP>
+inline float delayRead(const DelayLine &line, float distance, DelayTap &tap){
+    const float* buffer = line.buffer.data();
+    const unsigned mask = line.mask;
+
+    if (INTERP == DELAY_LINEAR){
+        unsigned whole = (unsigned)distance;
+        float frac = distance - whole;
+        float a = buffer[(line.index - whole) & mask];
+        float b = buffer[(line.index - whole - 1) & mask];
+        return a + frac * (b - a);
+    }
+    else if (INTERP == DELAY_ALLPASS){
+        // Fraction kept in [0.5, 1.5), where the allpass delay is accurate
+        unsigned whole = (unsigned)(distance - 0.5f);
+        float frac = distance - whole;
+        float eta = (1.0f - frac) / (1.0f + frac);
+        float a = buffer[(line.index - whole) & mask];
+        float b = buffer[(line.index - whole - 1) & mask];
+        float y = eta * (a - tap.allpass) + b;
+        tap.allpass = y;
+        return y;
+    }
+    else{
+        // Points one before to two after, at -1 .. 2 around the fraction
+        unsigned whole = (unsigned)distance;
+        float f = distance - whole;
+        const unsigned p = line.index - whole;
+        float fp1 = f + 1.0f, fm1 = f - 1.0f, fm2 = f - 2.0f;
+        return -f * fm1 * fm2 * (1.0f / 6.0f) * buffer[(p + 1) & mask]
+             + fp1 * fm1 * fm2 * 0.5f         * buffer[p & mask]
+             - fp1 * f * fm2 * 0.5f           * buffer[(p - 1) & mask]
+             + fp1 * f * fm1 * (1.0f / 6.0f)  * buffer[(p - 2) & mask];
+    }
+}
+
+// After delayWriteBlock of frames samples: out[i] is frame i of that block
+// delayed by delays[i] samples (out may alias delays)
+template <DelayInterp INTERP>
+void delayReadBlock(const DelayLine &line, const float* delays, float* out,
+                    unsigned long frames, DelayTap &tap){
+    for (unsigned long i = 0; i < frames; i++)
+        out[i] = delayRead<INTERP>(line, delays[i] + (float)(frames - i), tap);
+}
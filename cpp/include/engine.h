@@ -0,0 +1,140 @@
+/*
+ * engine.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the multi-instance engine. One device block
+ * (e.g. 16 channels of a multichannel interface) is split between several
+ * independent instances, each with its own AudioParams, EffectChoices and
+ * RtUserData (its own chain, parameters and live control queue). Every
+ * period the instances run as jobs on a fixed pool of worker threads.
+ *
+ * NOTE: Scheduling, per period:
+ *   - jobs are ordered longest first by each instance's measured cost and
+ *     dealt to the least loaded queue (one queue per thread, the calling
+ *     audio thread included), so the critical path starts first
+ *   - each thread takes jobs from the front of its own queue and, once it
+ *     is empty, steals from the back of the others'
+ *   - the caller works too, then waits for the last job; a period that
+ *     took longer than its real-time deadline is counted as a miss
+ * Queues are a packed atomic range [front, back) tagged with the period,
+ * so a take or steal is one compare-and-swap and a late thief can never
+ * claim a job of the wrong period. Idle workers spin briefly and then
+ * sleep on a futex. Nothing is allocated or locked after engineInit.
+ *
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "arena.h"
+#include "rtthread.h"
+#include "types.h"
+
+#define ENGINE_MAX_INSTANCES 32
+#define ENGINE_MAX_THREADS   32         // including the calling thread
+#define ENGINE_SPIN          20000      // polls before an idle worker sleeps
+#define ENGINE_COST_SHIFT    3          // cost estimate: moving average over 2^3 periods
+
+// Engine settings
+struct EngineConfig{
+    int  threads = 1;           // threads processing a period, the caller included
+    RtThreadConfig worker;      // priority / memory locking of the worker threads
+    bool pin = false;           // pin worker i to CPU i (the caller is left alone)
+};
+
+// One independent signal path
+struct EngineInstance : CacheAligned {
+    AudioParams   params;
+    EffectChoices effects;
+    RtUserData    ud;
+    int firstChannel = 0;               // first device channel it reads and writes
+    ArenaVector<unsigned char> in;      // its channels of the period, interleaved
+    ArenaVector<unsigned char> out;
+    uint32_t costNs = 0;                // moving average of its processing time
+};
+
+// Job queue of one thread (one cache line, written by several threads)
+struct alignas(64) EngineQueue{
+    std::atomic<uint64_t> range{0};     // period tag << 32 | back << 16 | front
+    uint8_t jobs[ENGINE_MAX_INSTANCES];
+};
+
+// Engine statistics (relaxed; steals are counted by every thread, the
+// rest by the calling thread)
+struct EngineStats{
+    std::atomic<uint32_t> periods{0};
+    std::atomic<uint32_t> deadlineMisses{0};
+    std::atomic<uint32_t> steals{0};
+    std::atomic<uint32_t> lastPeriodNs{0};
+};
+
+struct Engine;
+
+// Worker thread argument
+struct EngineWorker{
+    Engine*   engine = nullptr;
+    int       index  = 0;               // its queue
+    pthread_t thread;
+    bool      started = false;
+};
+
+struct Engine{
+    std::vector<EngineInstance*> instances;
+    int channels = 0;                   // device channels
+    int sampleRate = 44100;
+    SampleFormat format = FORMAT_S16;
+    unsigned long maxFrames = 0;        // longest period accepted
+
+    int threads = 1;
+    EngineQueue  queues[ENGINE_MAX_THREADS];
+    EngineWorker workers[ENGINE_MAX_THREADS];   // [0] is the caller (no thread)
+
+    // Period being processed (set by the caller before it is published)
+    const void*   in = nullptr;
+    void*         out = nullptr;
+    unsigned long frames = 0;
+
+    alignas(64) std::atomic<uint32_t> period{0};        // bumped to start a period (futex word)
+    alignas(64) std::atomic<int>      remaining{0};     // jobs not finished yet
+    std::atomic<int>  sleeping{0};                      // workers waiting on the futex
+    std::atomic<bool> running{false};
+
+    EngineStats stats;
+};
+
+
+// --- Control side ---
+
+// Create the instances (channels split evenly between them, each starting
+// from params / effects and the impulse response ir) and start the
+// workers. Returns 0 on success, or prints the reason and returns -1.
+int engineInit(Engine &engine, const EngineConfig &config, int instances,
+               const AudioParams &params, const EffectChoices &effects,
+               const ImpulseResponse &ir, unsigned long maxFrames);
+
+// Stop the workers and free the instances
+void engineShutdown(Engine &engine);
+
+// Give every instance the same chain (not while streaming)
+void engineSetEffects(Engine &engine, const EffectChoices &effects);
+
+// Reset every instance's DSP state (not while streaming)
+void engineReset(Engine &engine);
+
+// Send a control line to one instance ("<n>: <command>", n from 1) or,
+// without a prefix, to all of them. Returns false on a bad line.
+bool engineControlLine(Engine &engine, const std::string &line);
+
+
+// --- Audio side ---
+
+// Process one period of interleaved device frames (in and out in the
+// engine's format and channel count, frames <= maxFrames)
+void engineProcess(Engine &engine, const void* in, void* out, unsigned long frames);
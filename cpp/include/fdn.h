@@ -0,0 +1,54 @@
+/*
+ * fdn.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the feedback delay network reverb. FDN_LINES
+ * delay lines are fed back through a Householder matrix, each with a
+ * one-pole damping filter and a decay gain set from the reverb time.
+ *
+ * NOTE: The lines share one buffer, frame interleaved (buffer[pos *
+ * FDN_LINES + line]), whose length is a power of two, so indexing is a
+ * mask and each frame's write is one contiguous vector. All per-line math
+ * runs across the lines at once (SSE/AVX or NEON, picked at startup). The
+ * Householder matrix (I - 2/N * 1 1^T) costs one sum per frame instead of
+ * a matrix multiply.
+ *
+*/
+
+#pragma once
+
+#include "arena.h"
+
+#define FDN_LINES 8
+
+// Reverb state
+struct FdnReverb{
+    ArenaVector<float> buffer;          // size * FDN_LINES floats
+    int   mask  = 0;                    // size - 1
+    int   index = 0;                    // write position
+    int   delay[FDN_LINES] = {};        // line lengths in samples
+    float gain[FDN_LINES]  = {};        // per-line decay for the reverb time
+    float lowpass[FDN_LINES] = {};      // damping filter state
+    float damping = 0.0f;
+};
+
+// Size the lines for a sample rate and clear them (allocates)
+void fdnInit(FdnReverb &fdn, float sampleRate);
+
+// Set the time for the tail to fall by 60 dB and the high frequency
+// damping (0 = none, up to but not including 1)
+void fdnSetDecay(FdnReverb &fdn, float reverbTime, float damping, float sampleRate);
+
+// Clear the lines
+void fdnReset(FdnReverb &fdn);
+
+// Reverberate one block in place. Lines are fed from and mixed back to the
+// channels round robin (line k <-> channel k % channels).
+void fdnProcess(FdnReverb &fdn, float* const* block, int channels,
+                unsigned long frames, float mix);
+
+// Name of the kernel selected at startup ("avx", "sse", "neon" or "scalar")
+const char* fdnKernelName();
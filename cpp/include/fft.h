@@ -0,0 +1,39 @@
+/*
+ * fft.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of a real FFT used by the convolution engine.
+ * A real transform of size N runs as a complex radix-2 FFT of size N / 2
+ * plus a split step. Spectra are kept as separate real / imaginary arrays
+ * of N / 2 + 1 bins, so spectrum math runs over contiguous floats.
+ *
+*/
+
+#pragma once
+
+#include "arena.h"
+
+// Tables and scratch for one transform size (not shared between threads)
+struct FftPlan{
+    int size = 0;                       // real transform size (power of two, >= 4)
+    ArenaVector<int>   bitReverse;      // size / 2 entries
+    ArenaVector<float> twiddleCos;      // complex FFT twiddles, size / 4 entries
+    ArenaVector<float> twiddleSin;
+    ArenaVector<float> splitCos;        // e^(-2 pi i k / size), size / 2 entries
+    ArenaVector<float> splitSin;
+    ArenaVector<float> workRe;          // size / 2 scratch
+    ArenaVector<float> workIm;
+};
+
+// Build the tables for a transform size (allocates)
+void fftInit(FftPlan &plan, int size);
+
+// size real samples -> size / 2 + 1 bins
+void fftRealForward(FftPlan &plan, const float* in, float* re, float* im);
+
+// size / 2 + 1 bins -> size real samples (scaled by 1 / size, so a forward
+// and inverse transform give the input back)
+void fftRealInverse(FftPlan &plan, const float* re, const float* im, float* out);
@@ -0,0 +1,48 @@
+/*
+ * fir.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the block FIR filter engine. Used by the tone
+ * filter of overdrive, distortion and fuzz.
+ *
+ * NOTE: Each filter keeps its input history in a linear buffer. A block is
+ * copied in after the history, every output is a dot product over
+ * contiguous memory (computed several outputs at a time with SIMD), and the
+ * history is moved down once per chunk instead of once per sample.
+ *
+*/
+
+#pragma once
+
+#define MAX_FIR_TAPS 256
+#define FIR_CHUNK    256        // frames filtered per pass over the history
+
+// Filter coefficients
+struct FirCoefficients{
+    int   taps = 0;
+    float coeffs[MAX_FIR_TAPS] = {};    // coeffs[0] multiplies the newest sample
+};
+
+// Per-filter history
+struct FirState{
+    float line[MAX_FIR_TAPS - 1 + FIR_CHUNK] = {};
+};
+
+// Load coefficients (taps is clamped to MAX_FIR_TAPS)
+void firSetCoefficients(FirCoefficients &fir, const float* coeffs, int taps);
+
+// Design a Hamming windowed-sinc lowpass, normalized to unity gain at DC
+void firDesignLowpass(FirCoefficients &fir, int taps, float cutoffHz, float sampleRate);
+
+// Clear the history
+void firReset(FirState &state);
+
+// Filter a block (in and out may be the same buffer)
+void firProcess(const FirCoefficients &fir, FirState &state,
+                const float* in, float* out, unsigned long frames);
+
+// Name of the kernel selected at startup ("avx", "sse", "neon" or "scalar")
+const char* firKernelName();
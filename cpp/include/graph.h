@@ -0,0 +1,158 @@
+/*
+ * graph.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the effect graph. Instead of one chain, the
+ * block can be routed through splits whose branches are processed side by
+ * side and mixed back together, e.g. "6[|3:0.5|4:0.5]" is overdrive, then
+ * dry + delay + reverb. Independent nodes of a graph run concurrently on
+ * a small pool of worker threads (the audio thread included).
+ *
+ * NOTE: A routing is compiled once, on the control side, into nodes in
+ * topological order (node 0 is the input, the last node the output), each
+ * with the set of nodes it has to wait for. Buffers are assigned at compile
+ * time from a pool by liveness: a node writes in place over its input when
+ * nothing else still needs that input, and otherwise takes a pool buffer
+ * whose value every reader is already known to have finished with (an
+ * ancestor of the node), so reuse stays correct however the nodes are
+ * scheduled. The pool has GRAPH_MAX_BUFFERS buffers; a routing that needs
+ * more is refused.
+ *
+ * Every effect keeps a single set of state in RtUserData, so an effect can
+ * appear once per graph. Effects that use the shared scratch buffers
+ * (scratchBuffer, dryBuffer, the oversampler) are also ordered among
+ * themselves; delay, reverb, bitcrush and the multi-tap delay have none and
+ * run next to anything.
+ *
+ * Graphs are built into a free slot of a GraphBank and handed to the audio
+ * path with a SET_GRAPH command (control.h), like the waveshaper tables.
+ *
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <pthread.h>
+#include "arena.h"
+#include "rtthread.h"
+#include "slots.h"
+
+#define GRAPH_MAX_NODES    32       // effects and mixes, the input included
+#define GRAPH_MAX_BRANCHES 8        // branches of one split
+#define GRAPH_MAX_BUFFERS  6        // pool buffers besides the block
+#define GRAPH_MAX_CHANNELS 8        // AudioParams::MAX_CHANNELS
+#define GRAPH_MAX_THREADS  8        // including the audio thread
+#define GRAPH_SLOTS        3        // graphs per bank (playing, being built)
+#define GRAPH_SPIN         20000    // polls before an idle worker sleeps
+
+struct RtUserData;
+
+// Effect processing function (whole block)
+typedef void (*EffectProcess)(float* const* block, unsigned long frames, RtUserData* ud);
+
+enum GraphNodeKind{
+    GRAPH_INPUT,                // the block as it came in
+    GRAPH_EFFECT,               // one effect over its input
+    GRAPH_MIX                   // weighted sum of the branches of a split
+};
+
+struct GraphNode{
+    GraphNodeKind kind = GRAPH_INPUT;
+    int           effect = 0;                   // EffectType of an effect node
+    EffectProcess process = nullptr;
+    int      inputs[GRAPH_MAX_BRANCHES] = {};   // nodes whose outputs it reads
+    float    gains[GRAPH_MAX_BRANCHES] = {};    // mix: weight of each input
+    int      inputCount = 0;
+    int      buffer = 0;                        // where its output goes (0 = the block)
+    uint32_t after = 0;                         // nodes to wait for (data and ordering)
+    uint32_t next  = 0;                         // nodes waiting for it
+};
+
+struct EffectGraph{
+    GraphNode nodes[GRAPH_MAX_NODES];
+    int  count = 1;                 // just the input: pass through
+    int  buffers = 0;               // pool buffers used
+    bool parallel = false;          // some nodes may run at the same time
+};
+
+// Graph slots of one RtUserData
+struct GraphBank{
+    EffectGraph graphs[GRAPH_SLOTS];
+    SlotPool<GRAPH_SLOTS> pool;             // which slots are playing or about to
+    int active = -1;                        // audio side: graph being played (-1 = the chain)
+};
+
+// Buffers and workers that run a graph
+struct GraphRunner{
+    ArenaVector<float> pool;                // GRAPH_MAX_BUFFERS x channels x block frames
+    float* buffers[GRAPH_MAX_BUFFERS + 1][GRAPH_MAX_CHANNELS] = {};     // [0] is the block
+    int channels = 0;
+
+    // Run being processed (set by the caller before it is published)
+    const EffectGraph* graph = nullptr;
+    unsigned long frames = 0;
+    RtUserData* ud = nullptr;
+
+    std::atomic<int>      pending[GRAPH_MAX_NODES];     // nodes each one still waits for
+    std::atomic<uint64_t> ready[GRAPH_MAX_NODES];       // run tag << 32 | node, in ready order
+    std::atomic<uint64_t> queue{0};                     // run tag << 32 | back << 16 | front
+    std::atomic<uint32_t> run{0};                       // bumped to start a run (futex word)
+    std::atomic<int>      remaining{0};                 // nodes not finished yet
+    std::atomic<int>      sleeping{0};                  // workers waiting on the futex
+    std::atomic<bool>     running{false};
+
+    pthread_t threads[GRAPH_MAX_THREADS];   // [0] is the caller (no thread)
+    int threadCount = 1;
+
+    GraphRunner(){
+        for (int i = 0; i < GRAPH_MAX_NODES; i++){
+            pending[i] = 0;
+            ready[i] = 0;
+        }
+    }
+    ~GraphRunner();
+};
+
+
+// --- Control side ---
+
+// Compile a routing: menu keys run in series, "[a|b|...]" runs branches
+// side by side from the same input and sums them, each weighted by an
+// optional ":gain" (1 / branches by default); an empty branch is the dry
+// signal. Returns 0 on success, or prints the reason and returns -1.
+int graphParse(const std::string &spec, EffectGraph &graph);
+
+// Compile a routing into a free slot. Returns the slot, or prints the
+// reason and returns -1.
+int graphBuild(GraphBank &bank, const std::string &spec);
+
+// Compile a routing and play it straight away (not while streaming)
+int graphLoad(GraphBank &bank, const std::string &spec);
+
+// Play the chain again and free every slot (not while streaming)
+void graphReset(GraphBank &bank);
+
+// Size the buffer pool for a channel count (allocates)
+void graphInit(GraphRunner &runner, int channels);
+
+// Start threads - 1 workers (the caller is the other one). Returns the
+// number of threads that will run graphs.
+int graphStartWorkers(GraphRunner &runner, int threads, const RtThreadConfig &config);
+
+// Stop the workers
+void graphStopWorkers(GraphRunner &runner);
+
+
+// --- Audio side ---
+
+// Play a slot built by graphBuild, or the chain again (slot -1)
+void graphSwitch(GraphBank &bank, int slot);
+
+// Run a graph over a block (in place, frames <= RtUserData::MAX_BLOCK_FRAMES)
+void graphRun(GraphRunner &runner, const EffectGraph &graph, float* const* block,
+              unsigned long frames, RtUserData* ud);
@@ -0,0 +1,30 @@
+/*
+ * init.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of DSP state initialization, shared by the
+ * ALSA program and the offline render tool.
+ *
+*/
+
+#pragma once
+
+#include <string>
+#include "types.h"
+
+// Initialize DSP data
+void initData(RtUserData &ud, AudioParams &audioParams, EffectChoices &effectChoice);
+
+// Reset DSP data
+void resetData(RtUserData &ud);
+
+// Set the tempo of the multi-tap delay's note division taps (20 to 300
+// BPM). Returns 0 on success.
+int setTempo(const std::string &bpm, AudioParams &audioParams);
+
+// Set the oversampling factors of the nonlinear effects from "4" (all of
+// them) or a list like "od=2,fuzz=8". Returns 0 on success.
+int setOversampling(const std::string &spec, AudioParams &audioParams);
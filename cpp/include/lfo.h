@@ -0,0 +1,67 @@
+/*
+ * lfo.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the LFO engine used by the modulation
+ * effects (tremolo, phaser, ...).
+ *
+ * NOTE: The phase is a 32-bit fixed-point accumulator (a full cycle is
+ * 2^32), so it wraps by itself and never drifts. The top LFO_TABLE_BITS
+ * bits index a wavetable and the rest give the interpolation fraction.
+ * Tables are built once at startup from a limited number of harmonics,
+ * so square and saw waves have soft edges instead of clicking.
+ *
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#define LFO_TABLE_BITS     11
+#define LFO_TABLE_SIZE     (1 << LFO_TABLE_BITS)
+#define LFO_HARMONICS      32       // highest harmonic in the tables
+#define LFO_CONTROL_FRAMES 16       // frames per value for block rate users
+
+enum LfoWave{
+    LFO_SINE,
+    LFO_TRIANGLE,
+    LFO_SAW,            // rising
+    LFO_SQUARE,
+    NUM_LFO_WAVES
+};
+
+enum LfoInterp{
+    LFO_LINEAR,
+    LFO_CUBIC           // Catmull-Rom
+};
+
+// One oscillator. Output is in [-1, 1].
+struct Lfo{
+    uint32_t  phase     = 0;
+    uint32_t  increment = 0;        // phase step per frame
+    LfoWave   wave      = LFO_SINE;
+    LfoInterp interp    = LFO_LINEAR;
+};
+
+// Set the rate (Hz) for a sample rate
+void lfoSetRate(Lfo &lfo, float hz, float sampleRate);
+
+// Set the phase (in cycles, 0 to 1)
+void lfoSetPhase(Lfo &lfo, float cycles);
+
+// Value at the current phase
+float lfoValue(const Lfo &lfo);
+
+// Move the phase on by a number of frames
+inline void lfoAdvance(Lfo &lfo, unsigned long frames){
+    lfo.phase += (uint32_t)(lfo.increment * frames);
+}
+
+// One value per frame into out, advancing the phase
+void lfoRender(Lfo &lfo, float* out, unsigned long frames);
+
+// Name of a waveform ("sine", "triangle", "saw", "square")
+const char* lfoWaveName(LfoWave wave);
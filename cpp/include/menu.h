@@ -11,10 +11,14 @@
 
 #pragma once
 
+#include <string>
 #include "types.h"
 
 // Choice function
 void choiceSelect(char choice, EffectChoices &effectChoice, bool &validChoice, bool &exitFlag);
 
+// Chain choice function (one menu number per effect, in chain order)
+void chainSelect(const std::string &choices, EffectChoices &effectChoice, bool &validChoice, bool &exitFlag);
+
 // Menu function
 bool menuFunction(EffectChoices &effectChoice);
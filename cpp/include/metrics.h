@@ -0,0 +1,99 @@
+/*
+ * metrics.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of streaming metrics: per-block processing time
+ * histogram, XRUN counters, round-trip latency and CPU load as a fraction
+ * of the period.
+ *
+ * NOTE: The audio thread is the only writer and only does relaxed stores
+ * to fixed-size atomic counters (no locks, no allocation). Readers take a
+ * snapshot from another thread.
+ *
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+// Processing time histogram: 4 bins per octave from 2^MIN_OCTAVE ns
+#define METRICS_BINS_PER_OCTAVE 4
+#define METRICS_MIN_OCTAVE      8           // 256 ns
+#define METRICS_OCTAVES         24          // up to ~4.3 s
+#define METRICS_BINS            (METRICS_OCTAVES * METRICS_BINS_PER_OCTAVE)
+
+struct Metrics;
+
+// Clear all counters (not while the audio thread is running)
+void metricsReset(Metrics &metrics, unsigned int sampleRate);
+
+struct Metrics{
+    std::atomic<uint32_t> processHist[METRICS_BINS];
+    std::atomic<uint32_t> blocks;
+    std::atomic<uint32_t> processMaxNs;
+    std::atomic<uint32_t> loadMaxPermille;      // worst block, processing time / period time
+    std::atomic<uint64_t> processNsTotal;
+    std::atomic<uint64_t> periodNsTotal;
+    std::atomic<uint32_t> xrunCapture;
+    std::atomic<uint32_t> xrunPlayback;
+    std::atomic<int32_t>  latencyFrames;        // capture + playback delay, -1 if unknown
+    std::atomic<uint32_t> sampleRate;
+
+    Metrics(){ metricsReset(*this, 0); }
+};
+
+// Values computed from a Metrics at one point in time
+struct MetricsSnapshot{
+    uint32_t blocks;
+    double   processP50Us;
+    double   processP99Us;
+    double   processMaxUs;
+    double   loadAvg;           // over the time since the previous snapshot
+    double   loadMax;           // worst single block
+    uint32_t xrunCapture;
+    uint32_t xrunPlayback;
+    int32_t  latencyFrames;
+    double   latencyMs;
+
+    // Totals at the time of the snapshot (for the next loadAvg)
+    uint64_t processNsTotal;
+    uint64_t periodNsTotal;
+};
+
+// --- Audio thread ---
+
+// Record one processed block
+void metricsRecordBlock(Metrics &metrics, uint32_t processNs, unsigned long frames);
+
+// Record an XRUN
+void metricsRecordXrun(Metrics &metrics, bool capture);
+
+// Record the current round-trip delay (capture + playback) in frames
+void metricsRecordLatency(Metrics &metrics, long frames);
+
+// --- Any thread ---
+
+// Take a snapshot; previous may be NULL (load average since reset)
+void metricsSnapshot(const Metrics &metrics, const MetricsSnapshot* previous, MetricsSnapshot &snapshot);
+
+// Print a snapshot as "key value" lines
+void metricsPrint(FILE* fp, const MetricsSnapshot &snapshot);
+
+// Periodically writes a snapshot to a stats file (replaced atomically)
+struct MetricsExporter{
+    const Metrics*    metrics = nullptr;
+    const char*       path = nullptr;
+    int               intervalMs = 1000;
+    std::atomic<bool> running{false};
+    std::thread       thread;
+};
+
+void startMetricsExporter(MetricsExporter &exporter, const Metrics &metrics,
+                          const char* path, int intervalMs);
+void stopMetricsExporter(MetricsExporter &exporter);
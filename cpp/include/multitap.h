@@ -0,0 +1,119 @@
+/*
+ * multitap.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the multi-tap delay. Up to MULTITAP_MAX_TAPS
+ * taps read one line per channel. Each tap has a time (ms, or a note
+ * division of the tempo), a gain, a pan and an amount fed back into the
+ * line through its own one-pole damping low-pass, so repeats get darker.
+ *
+ * NOTE: The line is processed a chunk at a time. A chunk is never longer
+ * than the shortest tap, so every tap of a chunk is a plain copy out of
+ * the line (all of it written before the chunk), and the per-sample loop
+ * only sums the taps and runs their damping filters side by side.
+ *
+ * A new pattern or tempo is queued from the control side (SET_TAPS /
+ * tap_bpm, see control.h) and crossfaded in over MULTITAP_FADE_MS; one
+ * arriving during a fade waits for it to finish. Pan is a balance: tap
+ * gains are split between even (left) and odd (right) channels with an
+ * equal power law, and ignored for mono.
+ *
+*/
+
+#pragma once
+
+#include <string>
+#include "arena.h"
+#include "delayline.h"
+
+#define MULTITAP_MAX_TAPS  8
+#define MULTITAP_MAX_MS    4000     // longest tap time the lines are sized for
+#define MULTITAP_CHUNK     256      // most frames per pass (tap copies stay in L1)
+#define MULTITAP_FADE_MS   50       // crossfade time of a pattern / tempo change
+
+// One tap as set by the user
+struct TapSetting{
+    float ms;           // time in milliseconds (when beats is 0)
+    float beats;        // time in beats (quarter notes) of the tempo
+    float gain;         // level in the output
+    float pan;          // -1 (left) to 1 (right)
+    float feedback;     // amount fed back into the line
+    float damping;      // low-pass in the feedback path (0 = none, below 1)
+    float numerator;    // note division as written: beats = 4 * numerator / denominator,
+    float denominator;  // times 1.5 dotted or 2/3 triplet (both 0 for ms taps)
+    int   suffix;       // '.' dotted, 't' triplet, 0 plain
+};
+
+// Taps of the multi-tap delay
+struct TapPattern{
+    int count = 2;
+    TapSetting taps[MULTITAP_MAX_TAPS] = {
+        {0.0f, 1.0f, 0.8f, -0.5f, 0.3f, 0.3f, 1.0f, 4.0f, 0},      // quarter note, left
+        {0.0f, 1.5f, 0.6f,  0.5f, 0.3f, 0.5f, 1.0f, 4.0f, '.'},    // dotted quarter, right
+    };
+};
+
+// A pattern at a tempo, as the audio path plays it
+struct MultiTapVoice{
+    int      count = 0;
+    unsigned distance[MULTITAP_MAX_TAPS] = {};      // samples
+    unsigned shortest = 1;                          // shortest distance
+    float    gain[2][MULTITAP_MAX_TAPS] = {};       // gain * pan, even / odd channels
+    float    monoGain[MULTITAP_MAX_TAPS] = {};
+    float    feedback[MULTITAP_MAX_TAPS] = {};
+    float    coeff[MULTITAP_MAX_TAPS] = {};         // damping low-pass, 1 - damping
+    ArenaVector<float> lowpass;                     // filter states, channel after channel
+};
+
+// Multi-tap delay state
+struct MultiTapDelay{
+    ArenaVector<DelayLine> lines;       // one per channel
+    MultiTapVoice voices[2];            // playing, and fading in
+    int   current = 0;
+    int   fadeFrames = 1;
+    int   fadeRemaining = 0;
+
+    TapPattern pattern;                 // latest pattern and tempo
+    float bpm = 120.0f;
+    bool  pending = false;              // not playing yet
+    int   sampleRate = 44100;
+
+    // Working buffers of one chunk
+    float taps[MULTITAP_MAX_TAPS][MULTITAP_CHUNK];
+    float wet[MULTITAP_CHUNK];
+    float feedback[MULTITAP_CHUNK];
+};
+
+
+// --- Control side ---
+
+// Parse a pattern: taps separated by commas, each
+// time[:gain[:pan[:feedback[:damping]]]]. The time is milliseconds ("375")
+// or a note division ("1/8"), dotted ("1/8.") or triplet ("1/8t").
+// Returns 0 on success, or prints the reason and returns -1.
+int multitapParse(const std::string &spec, TapPattern &pattern);
+
+// Whether a pattern holds only what multitapParse accepts (for patterns
+// that did not come from text, e.g. a binary preset bank)
+bool multitapValid(const TapPattern &pattern);
+
+// Size the lines and start playing a pattern (allocates)
+void multitapInit(MultiTapDelay &delay, const TapPattern &pattern, float bpm,
+                  int sampleRate, int channels);
+
+
+// --- Audio side ---
+
+// Clear the lines and filters, and play the latest pattern without a fade
+void multitapReset(MultiTapDelay &delay);
+
+// Queue a new pattern or tempo (crossfaded in by multitapProcess)
+void multitapSetPattern(MultiTapDelay &delay, const TapPattern &pattern);
+void multitapSetTempo(MultiTapDelay &delay, float bpm);
+
+// Delay one block in place
+void multitapProcess(MultiTapDelay &delay, float* const* block, int channels,
+                     unsigned long frames, float mix);
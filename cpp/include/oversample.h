@@ -0,0 +1,72 @@
+/*
+ * oversample.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the 2x / 4x / 8x oversampler wrapped around
+ * the waveshapers of overdrive, distortion and fuzz, so the harmonics they
+ * generate above the base Nyquist are filtered out instead of aliasing.
+ *
+ * NOTE: Each 2x stage is a linear phase half-band filter run in polyphase
+ * form. Every other tap of a half-band is zero except the centre (0.5), so
+ * one phase is a short FIR (fir.h, SIMD) over the even taps and the other
+ * is a plain delay. Stages are cascaded for 4x and 8x; the later stages
+ * only have to reject images far from the audio band, so they are shorter.
+ * The whole round trip delays the signal by a whole number of base frames
+ * (padded if needed), which oversampleAlign applies to the dry signal.
+ *
+*/
+
+#pragma once
+
+#include "fir.h"
+
+#define OVERSAMPLE_MAX_STAGES 3         // 8x
+#define OVERSAMPLE_CHUNK      256       // base rate frames per up / down pass
+#define OVERSAMPLE_DELAY      64        // short delay line length (power of two)
+
+// Short delay line (delays of up to OVERSAMPLE_DELAY - 1 samples)
+struct OversampleDelay{
+    float line[OVERSAMPLE_DELAY] = {};
+    int   index = 0;
+};
+
+// Half-band filters and scratch, shared by every oversampled channel
+struct Oversampler{
+    FirCoefficients branch[OVERSAMPLE_MAX_STAGES];      // 2x the even taps of each stage
+    float stage[OVERSAMPLE_MAX_STAGES][OVERSAMPLE_CHUNK << OVERSAMPLE_MAX_STAGES];
+    float even[OVERSAMPLE_CHUNK << (OVERSAMPLE_MAX_STAGES - 1)];
+    float odd[OVERSAMPLE_CHUNK << (OVERSAMPLE_MAX_STAGES - 1)];
+};
+
+// One oversampled channel of one effect
+struct OversampleState{
+    int factor  = 1;                // 1 (off), 2, 4 or 8
+    int stages  = 0;
+    int pad     = 0;                // top rate samples added to round the latency
+    int latency = 0;                // base rate frames
+    FirState        upHistory[OVERSAMPLE_MAX_STAGES];
+    FirState        downHistory[OVERSAMPLE_MAX_STAGES];
+    OversampleDelay upDelay[OVERSAMPLE_MAX_STAGES];
+    OversampleDelay downDelay[OVERSAMPLE_MAX_STAGES];
+    OversampleDelay padDelay;
+    OversampleDelay dryDelay;
+};
+
+// Design the half-band filters
+void oversamplerInit(Oversampler &os);
+
+// Set a channel's factor (1, 2, 4 or 8) and clear its state
+void oversampleReset(const Oversampler &os, OversampleState &state, int factor);
+
+// Upsample frames (<= OVERSAMPLE_CHUNK) base rate samples. Returns
+// frames * factor samples to process in place; with factor 1 that is x.
+float* oversampleUp(Oversampler &os, OversampleState &state, float* x, int frames);
+
+// Filter and decimate the samples returned by oversampleUp back into x
+void oversampleDown(Oversampler &os, OversampleState &state, float* x, int frames);
+
+// Delay a base rate signal (e.g. the dry signal) by the oversampling latency
+void oversampleAlign(OversampleState &state, float* x, unsigned long frames);
@@ -0,0 +1,92 @@
+/*
+ * pcm.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of ALSA PCM helpers: opening and configuring
+ * the capture/playback pair, linking them so they start and stop
+ * together, negotiating rate / format / channels, and probing the
+ * smallest period the device sustains.
+ *
+*/
+
+#pragma once
+
+#include <alsa/asoundlib.h>
+#include <poll.h>
+#include <string>
+#include "types.h"
+
+#define PCM_MAX_POLL_FDS 4              // poll descriptors kept per PCM
+
+// Layout of the capture/playback pair. rate, channels and format are
+// requests; after opening they hold what the device negotiated.
+struct PcmConfig{
+    unsigned int channels = 2;
+    unsigned int maxChannels = AudioParams::MAX_CHANNELS;  // most the caller can process
+    unsigned int rate = 44100;
+    SampleFormat format = FORMAT_S16;
+    bool anyFormat = false;             // take the best format the device has
+    snd_pcm_access_t access = SND_PCM_ACCESS_RW_INTERLEAVED;
+    snd_pcm_uframes_t period = 512;     // frames per period (updated to what the device accepted)
+    unsigned int periods = 4;           // buffer = period * periods
+    bool linked = false;                // capture and playback start/stop together
+};
+
+// Poll descriptors of one PCM, fetched before a streaming loop starts
+struct PcmPoll{
+    snd_pcm_t *handle = nullptr;
+    struct pollfd fds[PCM_MAX_POLL_FDS];
+    int count = 0;
+};
+
+// Name of a format ("s16", "s24", "s32", "float") and the reverse lookup
+// (returns NUM_FORMATS for an unknown name)
+const char* sampleFormatName(SampleFormat format);
+SampleFormat sampleFormatByName(const std::string &name);
+
+// Open a PCM and configure it. Returns 0 on success.
+int setupPCM(const char* device, snd_pcm_t** handle, snd_pcm_stream_t stream,
+        PcmConfig &config);
+
+// Apply hw/sw parameters to an open PCM. The rate is never resampled by
+// ALSA; config is updated to the rate, channels, format and period the
+// device accepted. Returns 0 on success.
+int configurePCM(snd_pcm_t* handle, snd_pcm_stream_t stream, PcmConfig &config);
+
+// Open capture and playback with the same negotiated format and link them
+// if config.linked is set (falls back to unlinked if the device refuses).
+// Returns 0 on success.
+int openDuplex(const char* device, snd_pcm_t** inHandle, snd_pcm_t** outHandle,
+        PcmConfig &config);
+
+// Change the period of an open (stopped) pair. Returns 0 on success.
+int reconfigureDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, PcmConfig &config);
+
+// Start streaming. Linked pairs get a buffer of silence queued for playback
+// and are started together; otherwise capture starts on its own.
+void startDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, const PcmConfig &config);
+
+// Stop both PCMs and prepare them for the next start
+void stopDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, const PcmConfig &config);
+
+// Try periods from minPeriod up to maxPeriod (doubling) and keep the first
+// one that streams for probeMs without an XRUN. The pair is left configured
+// with it. Returns 0 if a period passed, negative if none did (the pair is
+// then left at maxPeriod).
+int probePeriod(snd_pcm_t* inHandle, snd_pcm_t* outHandle, PcmConfig &config,
+        snd_pcm_uframes_t minPeriod, snd_pcm_uframes_t maxPeriod, int probeMs);
+
+// Fetch the poll descriptors of a PCM
+void pcmPollInit(PcmPoll &pcmPoll, snd_pcm_t* handle);
+
+// Wait up to timeoutMs for one PCM to be ready (or in error); true if it
+// is. Only that PCM is polled, so the other side of a duplex pair being
+// ready (playback nearly always is) does not wake the caller.
+bool pcmPollWait(PcmPoll &pcmPoll, int timeoutMs);
+
+// Expected round-trip latency in milliseconds: one capture period plus a
+// full playback buffer
+double pcmLatencyMs(const PcmConfig &config);
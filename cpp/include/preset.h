@@ -0,0 +1,115 @@
+/*
+ * preset.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of preset banks. A preset holds an effect chain
+ * (or a graph routing), multi-tap delay taps and any of the live
+ * parameters; a bank is a list of named presets. Banks are written as
+ * text and can be compiled to a binary file that is memory mapped as is.
+ *
+ * NOTE: The text form is the live control syntax (control.h), one command
+ * per line, under a [name] line per preset:
+ *
+ *     # comments and blank lines are skipped
+ *     [crunch]
+ *     chain 6b3
+ *     od_drive 3.5
+ *     mix 0.4
+ *
+ *     [ambient]
+ *     graph [3|b:0.5]
+ *     taps 1/4:0.8:-0.5:0.3,1/8.:0.6:0.5
+ *     tap_bpm 90
+ *
+ * Parameters a preset leaves out keep their current values; a preset with
+ * no chain or graph keeps the effects playing.
+ *
+ * The binary form is a PresetFileHeader followed by the Preset records,
+ * in host byte order. The header carries the version, the record size and
+ * the parameter count, so a file from a build with another layout is
+ * refused instead of misread (PRESET_VERSION is bumped when ParamId or a
+ * record changes). Every record is checked when the bank is loaded.
+ *
+ * Switching preset while streaming (sendPreset) does everything that
+ * costs anything on the control side: the routing is compiled into a
+ * graph slot and, with SHAPER_TABLES, the waveshaper tables are built
+ * into free slots. It then queues one SET_PRESET command, so the whole
+ * preset lands at one block boundary: the chain or graph and the taps
+ * switch there, the tables and parameters crossfade and ramp over
+ * SMOOTH_MS.
+ *
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "types.h"
+
+#define PRESET_MAGIC     "AFXBANK"      // 8 bytes with the terminator
+#define PRESET_VERSION   2
+#define PRESET_NAME_SIZE 32             // name, with the terminator
+#define PRESET_GRAPH_SIZE 96            // routing, with the terminator
+#define PRESET_MAX       256            // presets per bank
+
+// One preset (a record of the binary file)
+struct Preset{
+    char     name[PRESET_NAME_SIZE];
+    int32_t  chain[EffectChoices::MAX_CHAIN];   // EffectType, in order
+    int32_t  chainLength;               // -1: keep the effects playing
+    char     graph[PRESET_GRAPH_SIZE];  // routing played instead of the chain ("" = none)
+    uint32_t paramMask;                 // bit per ParamId the preset sets
+    float    params[NUM_PARAMS];
+    int32_t  hasTaps;
+    TapPattern taps;
+};
+
+// paramMask has a bit per parameter: past 32, widen it and bump PRESET_VERSION
+static_assert(NUM_PARAMS <= 32, "Preset::paramMask needs a bit per ParamId");
+
+// Start of the binary file
+struct PresetFileHeader{
+    char     magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t recordSize;                // sizeof(Preset)
+    uint32_t params;                    // NUM_PARAMS
+};
+
+// Presets, mapped from a binary file or parsed from text
+struct PresetBank{
+    const Preset* presets = nullptr;
+    int count = 0;
+
+    std::vector<Preset> parsed;         // text banks
+    void*  mapping = nullptr;           // binary banks
+    size_t mappingBytes = 0;
+
+    PresetBank() {}
+    PresetBank(const PresetBank&) = delete;
+    PresetBank& operator=(const PresetBank&) = delete;
+    ~PresetBank();
+};
+
+
+// --- Control side ---
+
+// Load a bank: a binary file (recognized by its magic) is mapped, anything
+// else is parsed as text. Returns 0 on success, or prints the reason and
+// returns -1.
+int presetLoadBank(const char* path, PresetBank &bank);
+
+// Write a bank as binary, or as text when the path ends in ".txt".
+// Returns 0 on success, or prints the reason and returns -1.
+int presetSaveBank(const char* path, const PresetBank &bank);
+
+// Find a preset by name (NULL if there is none)
+const Preset* presetFind(const PresetBank &bank, const std::string &name);
+
+// Apply a preset before initData: its parameters and taps to audioParams,
+// its chain to effectChoice
+void presetApply(const Preset &preset, AudioParams &audioParams, EffectChoices &effectChoice);
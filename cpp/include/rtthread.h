@@ -0,0 +1,57 @@
+/*
+ * rtthread.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of real-time thread helpers (SCHED_FIFO
+ * priority, CPU affinity, memory locking and pre-faulting) used to run
+ * audio I/O on its own thread.
+ *
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <pthread.h>
+
+// Real-time thread settings
+struct RtThreadConfig{
+    int  priority   = 80;       // SCHED_FIFO priority (1-99), 0 = normal scheduling
+    int  cpu        = -1;       // CPU to pin the thread to, -1 = any
+    bool lockMemory = true;     // mlockall() before starting
+};
+
+// Lock current and future pages in RAM. Returns 0 on success.
+int lockMemory();
+
+// Touch every page of a buffer so it is resident before streaming
+void prefaultBuffer(void* buffer, size_t bytes);
+
+// Touch the calling thread's stack (call first thing in the thread)
+void prefaultStack();
+
+// Busy-wait hint (inside spin loops)
+inline void cpuRelax(){
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Sleep while word still holds seen (may return early: check again).
+// Off Linux this only yields.
+void futexWait(std::atomic<uint32_t> &word, uint32_t seen);
+
+// Wake every thread sleeping on word
+void futexWakeAll(std::atomic<uint32_t> &word);
+
+// Start a thread with the configured priority and affinity. If real-time
+// scheduling is not permitted it warns and falls back to normal scheduling.
+// Returns 0 on success.
+int startRtThread(pthread_t* thread, const RtThreadConfig &config,
+                  void* (*function)(void*), void* arg);
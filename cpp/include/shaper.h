@@ -0,0 +1,124 @@
+/*
+ * shaper.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the waveshaper tables of overdrive and fuzz.
+ * Both shape with the curve x / (a + |x|), a = 1 / (factor * drive + 0.01),
+ * which costs a division per sample when computed directly. The tables
+ * sample the curve (and, for fuzz, the bias dependent normalization) so
+ * the audio path does a lookup with linear interpolation instead.
+ *
+ * NOTE: Tables are built on the control side when a drive / factor / bias
+ * parameter changes, into a free slot of a ShaperBank, and handed to the
+ * audio path with a SET_SHAPER command (control.h). The audio path
+ * crossfades from the old table to the new one over SMOOTH_MS and then
+ * marks the old slot free again. Nothing is built on the audio thread.
+ *
+ * The tables are used where a division costs much more than a lookup (ARM
+ * cores without vector divide). On x86 the compiler vectorizes the direct
+ * overdrive formula, which then beats a scalar lookup, so the effects keep
+ * computing the curve there. Build with -DSHAPER_TABLES=0/1 to override.
+ *
+*/
+
+#pragma once
+
+#include <cmath>
+#include "slots.h"
+
+#ifndef SHAPER_TABLES
+#if defined(__arm__) || defined(__aarch64__)
+#define SHAPER_TABLES 1
+#else
+#define SHAPER_TABLES 0
+#endif
+#endif
+
+#define SHAPER_SIZE     4096        // curve intervals (power of two)
+#define SHAPER_ENV_SIZE 256         // fuzz normalization intervals over the envelope
+#define SHAPER_SLOTS    4           // tables per bank (playing, fading out, being built)
+
+// Which effect a bank belongs to
+enum ShaperId{
+    SHAPER_OD,
+    SHAPER_FUZZ,
+    NUM_SHAPERS
+};
+
+// One set of tables for one parameter setting
+struct Waveshaper{
+    float a       = 1.0f;           // curve constant
+    float scale   = 1.0f;           // output gain (overdrive normalization)
+    float bias    = 0.0f;           // fuzz: bias at full envelope (max bias * drive)
+    float range   = 1.0f;           // curve is tabulated over [-range, range]
+    float toIndex = 0.0f;           // SHAPER_SIZE / (2 * range)
+    float curve[SHAPER_SIZE + 1];
+    float posScale[SHAPER_ENV_SIZE + 2];    // fuzz: 1 / normalization over the envelope
+    float negScale[SHAPER_ENV_SIZE + 2];    // (last entry repeated, so envelope 1 needs no clamp)
+};
+
+// Parameters a bank's tables are built from (control side copy)
+struct ShaperSettings{
+    float drive   = 1.0f;
+    float factor  = 1.0f;
+    float maxBias = 0.0f;
+};
+
+// Table slots of one effect
+struct ShaperBank{
+    Waveshaper slots[SHAPER_SLOTS];
+    SlotPool<SHAPER_SLOTS> pool;    // which slots are playing or about to
+
+    ShaperSettings settings;        // control side: settings of the newest table
+
+    int   current  = 0;             // audio side: table being played
+    int   previous = -1;            // table being faded out (-1 = none)
+    int   fadeRemaining = 0;        // frames left in the crossfade
+    float fadeStep = 0.0f;          // crossfade weight per frame
+    float fade     = 1.0f;          // weight of the current table
+};
+
+
+// --- Control side ---
+
+// Build the tables of a bank into slot 0 and make it current. Only while
+// the audio path is not running (initData).
+void shaperInit(ShaperBank &bank, ShaperId id, const ShaperSettings &settings);
+
+// Build tables for new settings into a free slot. Returns the slot, or -1
+// if every slot is still in use (the change is then dropped).
+int shaperBuild(ShaperBank &bank, ShaperId id, const ShaperSettings &settings);
+
+
+// --- Audio side ---
+
+// Start playing a slot built by shaperBuild, crossfading over fadeFrames
+void shaperSwitch(ShaperBank &bank, int slot, int fadeFrames);
+
+// Move the crossfade on by a number of frames
+void shaperAdvance(ShaperBank &bank, unsigned long frames);
+
+// x / (a + |x|) * scale, from the table inside the range
+inline float shaperCurve(const Waveshaper &w, float x){
+    float position = (x + w.range) * w.toIndex;
+    if (position < 0.0f || position >= (float)SHAPER_SIZE)
+        return x / (w.a + fabsf(x)) * w.scale;      // outside the table: exact
+
+    int i = (int)position;
+    float frac = position - i;
+    return w.curve[i] + frac * (w.curve[i + 1] - w.curve[i]);
+}
+
+// Fuzz: curve at x + bias, normalized for the bias (envelope in [0, 1])
+inline float shaperFuzz(const Waveshaper &w, float x, float envelope){
+    float shifted = x + w.bias * envelope;
+    float position = envelope * SHAPER_ENV_SIZE;
+    int i = (int)position;
+    float frac = position - i;
+
+    const float* scale = shifted >= 0.0f ? w.posScale : w.negScale;
+    return shaperCurve(w, shifted) * (scale[i] + frac * (scale[i + 1] - scale[i]));
+}
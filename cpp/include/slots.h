@@ -0,0 +1,65 @@
+/*
+ * slots.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of the slot pool that hands data built on the
+ * control side (waveshaper tables, effect graphs) to the audio path. The
+ * control side claims a free slot, builds into it and queues a command
+ * naming it; the audio path frees the slot once it stops reading it.
+ *
+*/
+
+#pragma once
+
+#include <atomic>
+
+template <int SLOTS>
+struct SlotPool{
+    std::atomic<bool> busy[SLOTS];      // slot is playing or about to (set by control, cleared by audio)
+
+    SlotPool(){
+        for (int i = 0; i < SLOTS; i++) busy[i] = false;
+    }
+};
+
+
+// --- Control side ---
+
+// Claim a free slot. Returns it, or -1 if every slot is in use.
+template <int SLOTS>
+int slotAcquire(SlotPool<SLOTS> &pool){
+    for (int i = 0; i < SLOTS; i++){
+        // Acquire: the audio path has stopped reading a slot it freed
+        if (pool.busy[i].load(std::memory_order_acquire)) continue;
+
+        pool.busy[i].store(true, std::memory_order_relaxed);
+        return i;
+    }
+    return -1;
+}
+
+// Give back a claimed slot that was never queued
+template <int SLOTS>
+void slotCancel(SlotPool<SLOTS> &pool, int slot){
+    pool.busy[slot].store(false, std::memory_order_relaxed);
+}
+
+// Free every slot but inUse (-1 = all). Only while the audio path is not
+// running.
+template <int SLOTS>
+void slotReset(SlotPool<SLOTS> &pool, int inUse){
+    for (int i = 0; i < SLOTS; i++)
+        pool.busy[i].store(i == inUse, std::memory_order_release);
+}
+
+
+// --- Audio side ---
+
+// Done reading a slot (release: the control side may rebuild it)
+template <int SLOTS>
+void slotRelease(SlotPool<SLOTS> &pool, int slot){
+    pool.busy[slot].store(false, std::memory_order_release);
+}
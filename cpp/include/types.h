@@ -6,19 +6,65 @@
  * 5 June 2025
  * 
  * Description: contains structs used in the program.
- * NOTE: Change AudioParams values to adjust audio effects
+ * NOTE: AudioParams values are the defaults; a preset bank (preset.h)
+ * changes them without recompiling
  * 
 */
 
 #ifndef TYPES_H
 #define TYPES_H
 
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <vector>
+#include "arena.h"
+#include "conv.h"
+#include "delayline.h"
+#include "fdn.h"
+#include "fir.h"
+#include "graph.h"
+#include "lfo.h"
+#include "multitap.h"
+#include "oversample.h"
+#include "shaper.h"
 
 // User Defined Data
 typedef int16_t SAMPLE;
 
+// Interleaved sample formats the audio path can read and write
+enum SampleFormat{
+    FORMAT_S16,         // int16
+    FORMAT_S24,         // 24 bits in the low three bytes of an int32
+    FORMAT_S32,         // int32
+    FORMAT_FLOAT,       // float in [-1, 1]
+    NUM_FORMATS
+};
+
+// Bytes per sample of a format
+inline int sampleBytes(SampleFormat format){
+    return format == FORMAT_S16 ? 2 : 4;
+}
+
+// Effects that can be placed in an effect chain (menu order)
+enum EffectType{
+    EFFECT_NORM,
+    EFFECT_TREM,
+    EFFECT_DELAY,
+    EFFECT_REVERB,
+    EFFECT_BITCRUSH,
+    EFFECT_OVERDRIVE,
+    EFFECT_DISTORTION,
+    EFFECT_FUZZ,
+    EFFECT_CABINET,
+    EFFECT_PHASER,
+    EFFECT_CHORUS,
+    EFFECT_FLANGER,
+    EFFECT_VIBRATO,
+    EFFECT_MULTITAP,
+    NUM_EFFECTS
+};
+
 // Primarily for menu and callback functions
 struct EffectChoices{
     bool norm       = false;
@@ -29,6 +75,18 @@ struct EffectChoices{
     bool overdrive  = false;
     bool distortion = false;
     bool fuzz       = false;
+    bool cabinet    = false;
+    bool phaser     = false;
+    bool chorus     = false;
+    bool flanger    = false;
+    bool vibrato    = false;
+    bool multitap   = false;
+
+    // Order the effects were chosen in (e.g. fuzz -> delay -> reverb).
+    // If empty, the set flags are chained in menu order.
+    static const int MAX_CHAIN = 8;
+    EffectType chain[MAX_CHAIN];
+    int chainLength = 0;
 };
 
 
@@ -41,15 +99,20 @@ struct AudioParams{
     // Tremolo
     float TREM_FREQ     = 4.0;      // tremolo frequency (Hz). lower the freq, the slower the tremolo effect vice versa
     float TREM_DEPTH    = 0.5;      // tremolo depth. 0 has no effect, 1 has full effect
-    float tremPhase    = 0.1;
+    LfoWave TREM_WAVE   = LFO_SINE;
 
     // Delay
-    static constexpr int DELAY_MS       = 500;      // delay in milliseconds
-    static constexpr float FEEDBACK    = 0.4;     // feedback amount (0 to 1)   -  for delay
+    float DELAY_MS      = 500;      // delay in milliseconds (a change crossfades to the new time)
+    static constexpr float DELAY_MAX_MS = 2000;     // longest delay the lines are sized for
+    float FEEDBACK      = 0.4;      // feedback amount (0 to 0.95)
+
+    // Multi-tap delay (see multitap.h). Note division taps follow TAP_BPM.
+    TapPattern TAPS;
+    float TAP_BPM       = 120;
 
-    // Reverb
-    static const int REVERB_TAPS        = 5;        // number of delay taps for reverb
-    static constexpr float reverbDecay  = 0.6;      // decay factor for reverb
+    // Reverb (feedback delay network, see fdn.h)
+    float REVERB_TIME    = 1.5;     // seconds for the tail to decay by 60 dB
+    float REVERB_DAMPING = 0.3;     // high frequency damping of the tail (0 to 0.99)
 
     // Bitcrush
     int DOWNSAMPLE_RATE = 12000;     // Rate to "resample" input signal (Hz) (Must NOT exceed sample rate)
@@ -73,8 +136,18 @@ struct AudioParams{
     float FUZZ_MAX_BIAS = 0.6;   // Must be between -1 to 1
     static constexpr float FUZZ_ATTACK = 8;  // In milliseconds
 
+    // Oversampling of the waveshapers above: 1 (off), 2, 4 or 8.
+    // Set before initData (e.g. --oversample), not live.
+    int OD_OVERSAMPLE   = 1;
+    int DIST_OVERSAMPLE = 1;
+    int FUZZ_OVERSAMPLE = 1;
+
     // Tone filter parameters
     // (The implementation of "tone" utilizes a windowed lowpass filter.)
+    // Set TONE_TAPS above 0 to design a longer windowed-sinc lowpass at
+    // TONE_CUTOFF instead of using TONE_COEFFICIENTS.
+    int   TONE_TAPS   = 0;
+    float TONE_CUTOFF = 3000;    // Hz
     static const int TONE_SIZE = 10;
     float TONE_COEFFICIENTS[TONE_SIZE] = {
         0.0139,
@@ -89,61 +162,277 @@ struct AudioParams{
         0.0139
     };
 
+    // Phaser (PHASER_STAGES first order allpasses swept by an LFO)
+    static constexpr int PHASER_STAGES    = 6;
+    static constexpr float PHASER_MIN_HZ  = 200;     // bottom of the sweep
+    static constexpr float PHASER_MAX_HZ  = 3200;    // top of the sweep (at full depth)
+    float PHASER_RATE     = 0.5;    // Hz
+    float PHASER_DEPTH    = 1.0;    // fraction of the sweep range (0 to 1)
+    float PHASER_FEEDBACK = 0.5;    // output fed back into the first stage
+    LfoWave PHASER_WAVE   = LFO_TRIANGLE;
+
+    // Chorus, flanger and vibrato (delay lines swept by an LFO, see delayline.h)
+    static constexpr float MOD_MAX_MS      = 50;    // longest swept delay the lines are sized for
+    static constexpr float CHORUS_DELAY_MS = 20;    // centre of the chorus sweep
+    float CHORUS_RATE     = 0.8;    // Hz
+    float CHORUS_DEPTH    = 3;      // sweep (ms, peak to peak)
+    static constexpr float FLANGER_MIN_MS  = 1;     // bottom of the flanger sweep
+    float FLANGER_RATE     = 0.25;  // Hz
+    float FLANGER_DEPTH    = 3;     // sweep (ms, peak to peak)
+    float FLANGER_FEEDBACK = 0.5;   // output fed back into the line
+    float VIBRATO_RATE    = 5;      // Hz
+    float VIBRATO_DEPTH   = 1;      // sweep (ms, peak to peak)
+
+    // Cabinet (convolution with the impulse response given by --ir)
+    float CONV_MIX = 1.0;
+
     // DC filter parameters
     // (An IIR with a zero at z = 1 and a pole "near" z = 1.)
     float DC_POLE_COEFFICENT = 0.995;
     float DC_MIX = 0.3;
 
-    static constexpr int CHANNELS   = 2;
-    static constexpr int SAMPLE_RATE   = 44100;
+    // Stream format (set to what the audio device negotiated before initData)
+    static constexpr int MAX_CHANNELS = 8;
+    int CHANNELS        = 2;
+    int SAMPLE_RATE     = 44100;
+    SampleFormat FORMAT = FORMAT_S16;
 };
 
 
-struct RtUserData {
+// Delay time in samples, kept inside what the allpass read and the lines allow
+inline float delayDistance(float ms, int rate){
+    float distance = ms * (float)rate / 1000;
+    if (distance < 1.5f) distance = 1.5f;
+    if (distance > AudioParams::DELAY_MAX_MS * (float)rate / 1000) distance = AudioParams::DELAY_MAX_MS * (float)rate / 1000;
+    return distance;
+}
 
-    AudioParams *params;
-    EffectChoices *effects;
 
-    // Sin
-    static constexpr int LUT_SIZE = 1024;      // look up table, less expensive than calling sin every iteration
-    float sineLUT[LUT_SIZE];
-    
-    RtUserData(){
-    	for (int i = 0; i < LUT_SIZE; i++)
-    	    sineLUT[i] = sinf(2.0f * AudioParams::PI * i / LUT_SIZE);
-    }
+// Parameters that can be changed while streaming (see control.h)
+enum ParamId{
+    PARAM_MIX,
+    PARAM_TREM_FREQ,
+    PARAM_TREM_DEPTH,
+    PARAM_OD_DRIVE,
+    PARAM_OD_TONE,
+    PARAM_OD_FACTOR,
+    PARAM_DIST_DRIVE,
+    PARAM_DIST_TONE,
+    PARAM_DIST_FACTOR,
+    PARAM_FUZZ_DRIVE,
+    PARAM_FUZZ_TONE,
+    PARAM_FUZZ_FACTOR,
+    PARAM_FUZZ_MAX_BIAS,
+    PARAM_DC_MIX,
+    PARAM_REVERB_TIME,
+    PARAM_REVERB_DAMPING,
+    PARAM_CONV_MIX,
+    PARAM_PHASER_RATE,
+    PARAM_PHASER_DEPTH,
+    PARAM_PHASER_FEEDBACK,
+    PARAM_DELAY_MS,
+    PARAM_CHORUS_RATE,
+    PARAM_CHORUS_DEPTH,
+    PARAM_FLANGER_RATE,
+    PARAM_FLANGER_DEPTH,
+    PARAM_FLANGER_FEEDBACK,
+    PARAM_VIBRATO_RATE,
+    PARAM_VIBRATO_DEPTH,
+    PARAM_DELAY_FEEDBACK,
+    PARAM_TAP_BPM,
+    NUM_PARAMS
+};
 
-    // Delay
-    std::vector<float> delayBuffer;
-    int delayIndex;
-    int delaySize;
+struct Preset;
+struct PresetBank;
 
-    // Reverb
-    std::vector<float> reverbBuffer;
-    int   reverbSize;
-    int   reverbIndex[AudioParams::REVERB_TAPS];
-    int   reverbDelay[AudioParams::REVERB_TAPS];     // delay in milliseconds for reverb
-    float reverbGain[AudioParams::REVERB_TAPS];
+// Command sent from the control side to the audio path
+struct ControlCommand{
+    enum Type { SET_PARAM, SET_CHAIN, SET_SHAPER, SET_TAPS, SET_GRAPH, SET_PRESET } type;
+    ParamId param;
+    float   value;
+    ShaperId shaper;            // SET_SHAPER: bank and the slot just built
+    int      slot;              // (SET_GRAPH / SET_PRESET: graph slot, -1 = none)
+    EffectType chain[EffectChoices::MAX_CHAIN];
+    int        chainLength;
+    TapPattern taps;            // SET_TAPS
+    const Preset* preset;       // SET_PRESET: the preset (in a loaded bank)
+    int shapers[NUM_SHAPERS];   // (and the table slot built per bank, -1 = none)
+};
 
-    // Bitcrush
-    //float sampleCount    = params->SAMPLE_RATE
-    int bitcrushCount  = 0;
-    float bitcrushSample = 0.0f;
+// Single producer / single consumer ring of commands (no locks, no allocation)
+struct CommandQueue{
+    static const unsigned CAPACITY = 256;       // must be a power of two
+    ControlCommand slots[CAPACITY];
+    std::atomic<unsigned> head{0};              // written by the control side
+    std::atomic<unsigned> tail{0};              // written by the audio path
+};
 
-    float tremIncrement;   // precomputed 2*pi*f / sampleRate
+// Linear ramp of one parameter towards its latest target
+struct ParamRamp{
+    float target = 0.0f;
+    float step   = 0.0f;        // change per frame
+    int   remaining = 0;        // frames left in the ramp
+};
 
-    // Fuzz
-    float fuzzSampleAvg = 0.0f;
-    int fuzzSampleCount = (params->FUZZ_ATTACK / 1000) * params->SAMPLE_RATE;
 
-    // Tone filter buffers
-    float odToneBuffer[AudioParams::TONE_SIZE] = {};
-    float distToneBuffer[AudioParams::TONE_SIZE] = {};
-    float fuzzToneBuffer[AudioParams::TONE_SIZE] = {};
+// Effect state. Each effect keeps its state in a block of its own, cache
+// line aligned so no two effects share a line, and laid out hot to cold:
+// first the parameters it reads, a snapshot of AudioParams with what is
+// derived from them worked out (see snapshotParams in control.h), then the
+// state its loops carry from block to block, then the handles of its
+// buffers in the arena. Per-channel state is an array per value, indexed
+// by channel. A chain only touches the blocks of the effects in it.
+
+struct alignas(64) TremoloState{
+    float depth = 0.0f;
+    Lfo   lfo;
+};
+
+// The time is read through an allpass tap; when DELAY_MS changes a second
+// tap at the new time is faded in, then takes over.
+struct alignas(64) DelayState{
+    float feedback = 0.0f;
+    float mix      = 0.0f;
+    float target   = 1.5f;          // samples, where DELAY_MS is heading (ramp target)
+    float distance = 1.5f;          // samples, current tap
+    float nextDistance = 1.5f;      // samples, tap being faded in
+    int   fadeFrames    = 1;
+    int   fadeRemaining = 0;
+    DelayTap current[AudioParams::MAX_CHANNELS];
+    DelayTap next[AudioParams::MAX_CHANNELS];
+    ArenaVector<DelayLine> lines;   // one per channel
+};
+
+struct alignas(64) ReverbState{
+    float mix = 0.0f;
+    FdnReverb fdn;
+};
+
+struct alignas(64) BitcrushState{
+    float mix  = 0.0f;
+    float hold = 1.0f;              // samples each held sample lasts
+    int   count = 0;                // shared so every channel is sampled at the same instants
+    float sample[AudioParams::MAX_CHANNELS] = {};
+};
+
+// Overdrive and distortion
+struct alignas(64) DriveState{
+    float tone  = 1.0f;
+    float mix   = 0.0f;
+    float a     = 1.0f;             // overdrive: x / (a + |x|) * scale
+    float scale = 1.0f;
+    float gain  = 1.0f;             // distortion: gain into the clip
+    FirState toneState[AudioParams::MAX_CHANNELS];
+    ArenaVector<OversampleState> oversample;        // one per channel
+};
+
+// Fuzz, with the DC filter after it
+struct alignas(64) FuzzState{
+    float tone    = 1.0f;
+    float a       = 1.0f;           // curve constant
+    float drive   = 1.0f;
+    float maxBias = 0.0f;
+    float dcPole  = 0.0f;
+    float dcMix   = 0.0f;
+    int   attackFrames = 1;         // attack of the average, in samples
+    float average[AudioParams::MAX_CHANNELS] = {};
+    float dcInput[AudioParams::MAX_CHANNELS] = {};
+    float dcOutput[AudioParams::MAX_CHANNELS] = {};
+    FirState toneState[AudioParams::MAX_CHANNELS];
+    ArenaVector<OversampleState> oversample;        // one per channel
+};
+
+// Phaser (allpass states per channel, stage after stage)
+struct alignas(64) PhaserState{
+    float mix        = 0.0f;
+    float feedback   = 0.0f;
+    float octaves    = 0.0f;        // width of the sweep
+    float piOverRate = 0.0f;
+    Lfo   lfo;
+    float input[AudioParams::MAX_CHANNELS][AudioParams::PHASER_STAGES] = {};
+    float output[AudioParams::MAX_CHANNELS][AudioParams::PHASER_STAGES] = {};
+    float last[AudioParams::MAX_CHANNELS] = {};     // output fed back
+};
+
+// Chorus, flanger and vibrato: a line per channel read centre +- swing
+// samples back as the LFO sweeps
+struct alignas(64) SweepState{
+    float mix      = 0.0f;
+    float feedback = 0.0f;          // flanger only
+    float centre   = 0.0f;          // samples
+    float swing    = 0.0f;          // samples
+    Lfo   lfo;
+    ArenaVector<DelayLine> lines;   // one per channel
+};
+
+struct alignas(64) MultitapState{
+    float mix = 0.0f;
+    MultiTapDelay delay;
+};
+
+// Cabinet: convolution with RtUserData::impulse
+struct alignas(64) CabinetState{
+    float mix = 0.0f;
+    Convolver convolver;
+};
+
+
+struct RtUserData : CacheAligned {
+
+    // Holds the vectors below (declared first: released last), see arena.h
+    Arena arena;
+
+    AudioParams *params = nullptr;
+    EffectChoices *effects = nullptr;
+
+    // Read once per block (copied from params by initData)
+    int          channels = 0;
+    SampleFormat format   = FORMAT_S16;
+    int          activeRamps = 0;       // parameters ramping (see ramps below)
+
+    // Effect state, menu order (see above)
+    TremoloState  trem;
+    DelayState    delay;
+    ReverbState   reverb;
+    BitcrushState bitcrush;
+    DriveState    overdrive;
+    DriveState    distortion;
+    FuzzState     fuzz;
+    CabinetState  cabinet;
+    PhaserState   phaser;
+    SweepState    chorus;
+    SweepState    flanger;
+    SweepState    vibrato;
+    MultitapState multitap;
+
+    // Shared by overdrive, distortion and fuzz: tone filter coefficients
+    // and the oversampler's filters and scratch
+    FirCoefficients toneFir;
+    Oversampler oversampler;
+
+    // Float working buffers for one block (one per channel)
+    static constexpr int MAX_BLOCK_FRAMES = 4096;
+    alignas(64) float blockBuffer[AudioParams::MAX_CHANNELS][MAX_BLOCK_FRAMES];
+    alignas(64) float dryBuffer[MAX_BLOCK_FRAMES];      // copy of an effect's input (one channel), for mixing
+    alignas(64) float scratchBuffer[MAX_BLOCK_FRAMES];  // temporary output of filters / modulators
+
+    // Live control (commands are applied at block boundaries)
+    CommandQueue commands;
+    ParamRamp    ramps[NUM_PARAMS];
+
+    // Waveshaper tables of overdrive and fuzz (indexed by ShaperId)
+    ShaperBank shapers[NUM_SHAPERS];
+
+    // Cabinet impulse response (loaded before initData)
+    ImpulseResponse impulse;
+
+    // Presets the "preset" command picks from (see preset.h)
+    const PresetBank* presets = nullptr;
 
-    // DC filter buffers
-    float dcInputBuffer = 0.0f;
-    float dcOutputBuffer = 0.0f;
+    // Effect graph (routing set with "graph", see graph.h) and its runner
+    GraphBank   graphs;
+    GraphRunner graphRunner;
 };
 
 
@@ -0,0 +1,36 @@
+/*
+ * wavfile.h
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Declaration of WAV / raw S16 file input and output,
+ * used by the offline render tool.
+ *
+*/
+
+#pragma once
+
+#include <vector>
+#include "types.h"
+
+// Audio held in memory as interleaved S16 frames
+struct AudioFile{
+    std::vector<SAMPLE> samples;
+    int  channels   = 2;
+    int  sampleRate = 44100;
+    bool isWav      = true;     // false for headerless raw S16_LE
+};
+
+// Returns true if the path ends in ".wav" (case insensitive)
+bool isWavPath(const char* path);
+
+// Read a 16-bit PCM WAV file, or a raw interleaved S16_LE file when the path
+// is not a .wav (raw files take channels/sample rate from the struct).
+// Returns 0 on success, negative on error.
+int readAudioFile(const char* path, AudioFile &file);
+
+// Write file.samples as a 16-bit PCM WAV, or raw S16_LE when !file.isWav.
+// Returns 0 on success, negative on error.
+int writeAudioFile(const char* path, const AudioFile &file);
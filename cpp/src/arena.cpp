@@ -0,0 +1,223 @@
+/*
+ * arena.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the DSP state arena and the audio path
+ * allocation tracker (replaces the global operator new / delete, and
+ * counts CacheAligned allocations too)
+*/
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sys/mman.h>
+#include "../include/arena.h"
+
+#define ARENA_MAX 128       // live arenas (one per RtUserData)
+
+
+// ---------------------------------------------------------------------------
+// Arena
+// ---------------------------------------------------------------------------
+
+// Live arenas, for arenaOwns (control side only)
+static std::mutex registryLock;
+static Arena* registry[ARENA_MAX];
+static int registryCount = 0;
+
+static thread_local Arena* scopeArena = nullptr;
+
+
+int arenaInit(Arena &arena, size_t bytes){
+    if (arena.base) return 0;
+    const size_t reserve = (bytes + ARENA_COMMIT - 1) & ~(ARENA_COMMIT - 1);
+
+    std::lock_guard<std::mutex> lock(registryLock);
+    if (registryCount >= ARENA_MAX){
+        fprintf(stderr, "Warning: more than %d arenas, DSP state goes on the heap\n", ARENA_MAX);
+        return -1;
+    }
+
+    // Reserve address space only (no access, no memory), one huge page
+    // more so the start can be aligned to one
+    const size_t mapped = reserve + ARENA_HUGE_PAGE;
+    void* mapping = mmap(NULL, mapped, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (mapping == MAP_FAILED){
+        fprintf(stderr, "Warning: could not reserve the DSP arena (%s), DSP state goes on the heap\n",
+                strerror(errno));
+        return -1;
+    }
+
+    unsigned char* start = (unsigned char*)mapping;
+    unsigned char* base = (unsigned char*)(((size_t)start + ARENA_HUGE_PAGE - 1) & ~(ARENA_HUGE_PAGE - 1));
+    if (base > start) munmap(start, base - start);
+    if (base + reserve < start + mapped) munmap(base + reserve, start + mapped - (base + reserve));
+
+#ifdef MADV_HUGEPAGE
+    madvise(base, reserve, MADV_HUGEPAGE);     // a hint: fine if it is refused
+#endif
+
+    arena.base = base;
+    arena.reserved = reserve;
+    arena.committed = 0;
+    arena.used = 0;
+    registry[registryCount++] = &arena;
+    return 0;
+}
+
+
+void* arenaAlloc(Arena &arena, size_t bytes){
+    if (!arena.base && !arena.measuring) return NULL;
+
+    const size_t align = bytes >= ARENA_HUGE_PAGE ? ARENA_HUGE_PAGE : ARENA_ALIGN;
+    size_t start = (arena.used + align - 1) & ~(align - 1);
+    if (arena.measuring){
+        arena.used = start + bytes;
+        return NULL;        // the caller falls back to the heap
+    }
+    if (start > arena.reserved || bytes > arena.reserved - start) return NULL;
+    size_t end = start + bytes;
+
+    // Commit up to the end (made accessible; locked too under mlockall)
+    if (end > arena.committed){
+        size_t target = (end + ARENA_COMMIT - 1) & ~(ARENA_COMMIT - 1);
+        if (mprotect(arena.base + arena.committed, target - arena.committed, PROT_READ | PROT_WRITE) < 0)
+            return NULL;
+        arena.committed = target;
+    }
+
+    arena.used = end;
+    return arena.base + start;
+}
+
+
+bool arenaOwns(const void* p){
+    const unsigned char* byte = (const unsigned char*)p;
+    std::lock_guard<std::mutex> lock(registryLock);
+    for (int i = 0; i < registryCount; i++)
+        if (byte >= registry[i]->base && byte < registry[i]->base + registry[i]->reserved) return true;
+    return false;
+}
+
+
+Arena::~Arena(){
+    if (!base) return;
+
+    std::lock_guard<std::mutex> lock(registryLock);
+    for (int i = 0; i < registryCount; i++)
+        if (registry[i] == this){
+            registry[i] = registry[--registryCount];
+            break;
+        }
+    munmap(base, reserved);
+}
+
+
+ArenaScope::ArenaScope(Arena &arena) : previous(scopeArena){
+    scopeArena = arena.base || arena.measuring ? &arena : nullptr;
+}
+
+ArenaScope::~ArenaScope(){
+    scopeArena = previous;
+}
+
+Arena* currentArena(){
+    return scopeArena;
+}
+
+
+
+// ---------------------------------------------------------------------------
+// Allocation tracker
+// ---------------------------------------------------------------------------
+
+static thread_local int audioPathDepth = 0;
+static std::atomic<unsigned long> audioAllocations{0};
+static std::atomic<unsigned long> audioBytes{0};
+
+AudioPathScope::AudioPathScope(){
+    audioPathDepth++;
+}
+
+AudioPathScope::~AudioPathScope(){
+    audioPathDepth--;
+}
+
+unsigned long audioPathAllocations(){
+    return audioAllocations.load(std::memory_order_relaxed);
+}
+
+unsigned long audioPathAllocatedBytes(){
+    return audioBytes.load(std::memory_order_relaxed);
+}
+
+
+// Count an allocation if the calling thread is on the audio path
+static void trackAllocation(size_t size){
+    if (audioPathDepth > 0){
+        audioAllocations.fetch_add(1, std::memory_order_relaxed);
+        audioBytes.fetch_add(size, std::memory_order_relaxed);
+    }
+}
+
+void* operator new(std::size_t size){
+    trackAllocation(size);
+    if (size == 0) size = 1;
+
+    void* p;
+    while (!(p = malloc(size))){
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size){
+    return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept{
+    try { return operator new(size); }
+    catch (...) { return nullptr; }
+}
+
+void operator delete(void* p) noexcept{
+    free(p);
+}
+
+void operator delete[](void* p) noexcept{
+    free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept{
+    free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept{
+    free(p);
+}
+
+
+void* CacheAligned::operator new(size_t bytes){
+    trackAllocation(bytes);
+
+    void* p;
+    if (posix_memalign(&p, ARENA_ALIGN, bytes) != 0) throw std::bad_alloc();
+    return p;
+}
+
+void CacheAligned::operator delete(void* p){
+    free(p);
+}
@@ -6,269 +6,702 @@
  * 
  * Description: Implementation of callback function.
  * Contains processing logic.
+ *
+ * NOTE: Blocks are deinterleaved into one float buffer per channel before
+ * the effect chain runs. Each effect copies its parameters and state into
+ * locals, runs one tight loop over the block per channel and writes the
+ * state back. Effects read only their own state block (types.h), whose
+ * parameters are a snapshot of AudioParams with anything rate dependent
+ * already worked out, never ud->params itself. Every effect processes all
+ * ud->channels channels. The
+ * waveshapers of overdrive, distortion and fuzz run in chunks through the
+ * oversampler (oversample.h), which passes them straight through at 1x.
 */
 
 #include "../include/callback.h"
+#include "../include/chain.h"
+#include "../include/control.h"
+#include "../include/convert.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+
+// Tone filter function (in place over a block)
+void applyToneFilter(float* block, unsigned long frames, RtUserData *ud, FirState &filterState, float toneAmount) {
+
+    /* NOTE: This was generalized for all 3 distortion effects, so filter state
+     * and tone parameter are directly passed to reduce calculation. */
+
+    // Apply tone coefficients for lowpass filter
+    float* filtered = ud->scratchBuffer;
+    firProcess(ud->toneFir, filterState, block, filtered, frames);
+
+    // Apply mix amount
+    for (unsigned long i = 0; i < frames; i++)
+        block[i] = toneAmount * block[i] + (1.0f - toneAmount) * filtered[i];
+}
+
+
+// DC filter function (in place over one channel of a block)
+void applyDCFilter(float* block, unsigned long frames, RtUserData *ud, int channel) {
 
-// Overdrive function
-float applyOverdrive(float inputSample, RtUserData *ud) {
-    
     // Effect parameters
-    float drive    = ud->params->OD_DRIVE;
-    float odFactor = ud->params->OD_FACTOR;
+    FuzzState &fuzz = ud->fuzz;
+    const float pole = fuzz.dcPole;
+    const float mix  = fuzz.dcMix;
 
-    // Apply transfer characteristic
-    float intensityFactor = 1 / (odFactor*drive + 0.01);
-    float normalizeFactor = 1 / (intensityFactor + 1);
-    float outputSample = (inputSample / (intensityFactor + abs(inputSample)));
-    outputSample /= normalizeFactor;
+    float x1 = fuzz.dcInput[channel];
+    float y1 = fuzz.dcOutput[channel];
 
-    return outputSample;
+    // Apply IIR equation for DC filter
+    // y[n] = x[n] - x[n-1] + Ry[n-1]
+    for (unsigned long i = 0; i < frames; i++){
+        float x = block[i];
+        float y = x - x1 + pole * y1;
+        x1 = x;
+        y1 = y;
+
+        // Apply mix amount
+        block[i] = mix * y + (1.0f - mix) * x;
+    }
+
+    fuzz.dcInput[channel] = x1;
+    fuzz.dcOutput[channel] = y1;
 }
 
-// Distortion function
-float applyDistortion(float inputSample, RtUserData *ud) {
-    
+
+// Tremolo effect
+void processTremolo(float* const* block, unsigned long frames, RtUserData* ud){
+
     // Effect parameters
-    float drive      = ud->params->DIST_DRIVE;
-    float distFactor = ud->params->DIST_FACTOR;
+    TremoloState &trem = ud->trem;
+    const float depth = trem.depth;
+
+    // Gain curve for the block, shared by every channel
+    // (1 - depth) + depth * (0.5 * (1 + lfo))
+    float* gain = ud->scratchBuffer;
+    lfoRender(trem.lfo, gain, frames);
+    for (unsigned long i = 0; i < frames; i++)
+        gain[i] = (1.0f - 0.5f * depth) + 0.5f * depth * gain[i];
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        for (unsigned long i = 0; i < frames; i++)
+            x[i] = x[i] * gain[i];
+    }
+}
 
-    // Apply transfer characteristic
-    float outputSample = (1 + (distFactor-1)*drive) * inputSample;
-    if (outputSample > 1.0f) outputSample = 1.0f;
-    if (outputSample < -1.0f) outputSample = -1.0f;
 
-    return outputSample;
+// Delay line run at a fixed time (no crossfade)
+static void delayRun(DelayLine &line, DelayTap &tap, float distance, float* x, unsigned long frames,
+                     float feedback, float mix){
+    const unsigned whole = (unsigned)distance;
+
+    if (distance == (float)whole){
+        // Whole number of samples: the allpass reads the sample unchanged,
+        // so skip its recursion and process in runs that end where the
+        // read or write position wraps (no branch in the inner loop)
+        const unsigned capacity = line.mask + 1;
+        float* buffer = line.buffer.data();
+        unsigned long i = 0;
+        while (i < frames){
+            unsigned readIndex = (line.index - whole) & line.mask;
+            unsigned long run = frames - i;
+            if (run > capacity - readIndex) run = capacity - readIndex;
+            if (run > capacity - line.index) run = capacity - line.index;
+
+            const float* delayed = buffer + readIndex;
+            float* stored = buffer + line.index;
+            float* y = x + i;
+            for (unsigned long n = 0; n < run; n++){
+                float in = y[n];
+                float delayedSample = delayed[n];
+
+                // store current input sample in delay buffer
+                stored[n] = in + delayedSample * feedback;
+
+                // Mix original and delayed signals
+                y[n] = (1.0f - mix) * in + mix * delayedSample;
+            }
+
+            i += run;
+            line.index = (line.index + run) & line.mask;
+        }
+        if (frames > 0) tap.allpass = delayTap(line, whole + 1);
+        return;
+    }
+
+    for (unsigned long i = 0; i < frames; i++){
+        float in = x[i];
+        float delayedSample = delayRead<DELAY_ALLPASS>(line, distance, tap);
+        delayWrite(line, in + delayedSample * feedback);
+        x[i] = (1.0f - mix) * in + mix * delayedSample;
+    }
 }
 
-// Fuzz function
-float applyFuzz(float inputSample, RtUserData *ud) {
-    
+
+// Delay effect
+void processDelay(float* const* block, unsigned long frames, RtUserData* ud){
+
     // Effect parameters
-    float drive       = ud->params->FUZZ_DRIVE;
-    float fuzzFactor  = ud->params->FUZZ_FACTOR;
-    float fuzzBias    = ud->params->FUZZ_MAX_BIAS;
-    int   fuzzAttack  = ud->fuzzSampleCount;
-
-    // Adjust average amplitude for reactive biasing
-    ud->fuzzSampleAvg = ud->fuzzSampleAvg + (fmin(1.414*abs(inputSample), 1.0) - ud->fuzzSampleAvg) / fuzzAttack;
-    fuzzBias *= ud->fuzzSampleAvg;
-
-    // Apply transfer characteristic
-    float intensityFactor = 1 / (fuzzFactor*drive + 0.01);
-    float biasFactor      = fuzzBias * drive;
-    float normalizeFactor;
-    if (inputSample >= -biasFactor)
-        normalizeFactor = (1 + biasFactor) / (intensityFactor + abs(1 + biasFactor));
-    else
-        normalizeFactor = (1 - biasFactor) / (intensityFactor + abs(-1 + biasFactor));
-    float outputSample = (inputSample + biasFactor) / (intensityFactor + abs(inputSample + biasFactor));
-    outputSample /= normalizeFactor;
+    DelayState &delay = ud->delay;
+    const float feedback = delay.feedback;
+    const float mix      = delay.mix;
+    const float target   = delay.target;
+
+    // A new time fades in on a second tap (once any running fade is done),
+    // so changing it never clicks or sweeps the pitch
+    if (delay.fadeRemaining == 0 && target != delay.distance){
+        delay.nextDistance = target;
+        delay.fadeRemaining = delay.fadeFrames;
+        for (int ch = 0; ch < ud->channels; ch++)
+            delay.next[ch] = delay.current[ch];
+    }
+
+    const float distance = delay.distance;
+    const float nextDistance = delay.nextDistance;
+    const float fadeStep = 1.0f / delay.fadeFrames;
+    const int startRemaining = delay.fadeRemaining;
+    int remaining = startRemaining;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        DelayLine &line = delay.lines[ch];
+        DelayTap &tap = delay.current[ch];
+        DelayTap &nextTap = delay.next[ch];
+        float* x = block[ch];
+        remaining = startRemaining;
+
+        // Crossfade from the current tap to the next
+        unsigned long i = 0;
+        for (; i < frames && remaining > 0; i++){
+            float in = x[i];
+            float delayedSample = delayRead<DELAY_ALLPASS>(line, distance, tap);
+            float next = delayRead<DELAY_ALLPASS>(line, nextDistance, nextTap);
+            remaining--;
+            delayedSample += (1.0f - remaining * fadeStep) * (next - delayedSample);
+
+            delayWrite(line, in + delayedSample * feedback);
+            x[i] = (1.0f - mix) * in + mix * delayedSample;
+        }
 
-    return outputSample;
+        // Rest of the block on a single tap
+        if (startRemaining > 0 && remaining == 0){
+            tap = nextTap;
+            delayRun(line, tap, nextDistance, x + i, frames - i, feedback, mix);
+        }
+        else
+            delayRun(line, tap, distance, x + i, frames - i, feedback, mix);
+    }
+
+    // Fade done: the new tap has taken over
+    if (startRemaining > 0 && remaining == 0)
+        delay.distance = nextDistance;
+    delay.fadeRemaining = remaining;
 }
 
 
-// Tone filter function
-float applyToneFilter(float inputSample, RtUserData *ud, float* filterBuffer, float toneAmount) {
+// Reverb effect
+void processReverb(float* const* block, unsigned long frames, RtUserData* ud){
 
-    /* NOTE: This was generalized for all 3 distortion effects, so buffer array
-     * and tone parameter are directly passed to reduce calculation. */
+    // Effect parameters
+    const float mix = ud->reverb.mix;
 
-    // Shift filter buffers over
-    for (int i = ud->params->TONE_SIZE - 2; i >= 0; i--)
-        filterBuffer[i+1] = filterBuffer[i];
-    filterBuffer[0] = inputSample;
+    fdnProcess(ud->reverb.fdn, block, ud->channels, frames, mix);
+}
 
-    // Apply tone coefficients for lowpass filter
-    float outputSample = SAMPLE_SILENCE;
-    for (int i = 0; i < ud->params->TONE_SIZE; i++)
-        outputSample += ud->params->TONE_COEFFICIENTS[i] * filterBuffer[i];
 
-    // Apply mix amount
-    outputSample = toneAmount * inputSample + (1.0f - toneAmount) * outputSample;
+// Bitcrush effect
+void processBitcrush(float* const* block, unsigned long frames, RtUserData* ud){
 
-    return outputSample;
+    // Effect parameters
+    BitcrushState &bitcrush = ud->bitcrush;
+    const float mix = bitcrush.mix;
+    const float step = AudioParams::BITCRUSH_STEP;
+    const float invStep = 1.0f / AudioParams::BITCRUSH_STEP;    // exact, step is a power of two
+
+    // Number of samples to hold
+    const float sampleCount = bitcrush.hold;
+
+    // The hold counter is shared so every channel is sampled at the same instants
+    const int startCount = bitcrush.count;
+    int count = startCount;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        float held = bitcrush.sample[ch];
+        float quantized = roundf(held * invStep) * step;
+        count = startCount;
+
+        for (unsigned long i = 0; i < frames; i++){
+            float in = x[i];
+
+            // Perform downsampling
+            if (count >= sampleCount){
+                // If bitcrush counter exceeds sample count, decrement counter & store new sample
+                count -= sampleCount;
+                held = in;
+
+                // Perform quantization (only changes when a new sample is held)
+                quantized = roundf(held * invStep) * step;
+            }
+            else
+                count++;
+
+            // Apply mix amount
+            x[i] = (1.0f - mix) * in + mix * quantized;
+        }
+
+        bitcrush.sample[ch] = held;
+    }
+
+    bitcrush.count = count;
 }
 
 
-// DC filter function
-float applyDCFilter(float inputSample, RtUserData *ud) {
+// Clamp and mix a processed block with the dry input
+static void clampAndMix(float* block, const float* dry, unsigned long frames, float mix){
+    for (unsigned long i = 0; i < frames; i++){
+        float outputSample = block[i];
 
-    // Apply IIR equation for DC filter
-    // y[n] = x[n] - x[n-1] + Ry[n-1]
-    float outputSample = inputSample - ud->dcInputBuffer + (ud->params->DC_POLE_COEFFICENT)*ud->dcOutputBuffer;
-    ud->dcInputBuffer = inputSample;
-    ud->dcOutputBuffer = outputSample;
+        // Adjust for overflow
+        if (outputSample > 1.0f) outputSample = 1.0f;
+        else if (outputSample < -1.0f) outputSample = -1.0f;
 
-    // Apply mix amount
-    outputSample = ud->params->DC_MIX * outputSample + (1.0f - ud->params->DC_MIX) * inputSample;
+        // Apply mix amount
+        block[i] = (1.0f - mix) * dry[i] + mix * outputSample;
+    }
+}
+
+
+// Overdrive transfer characteristic over count samples
+static void shapeOverdrive(float* x, int count, RtUserData* ud){
+#if SHAPER_TABLES
+    // Tables for drive and factor (see shaper.h)
+    const ShaperBank &shaper = ud->shapers[SHAPER_OD];
+    const Waveshaper &curve = shaper.slots[shaper.current];
 
-    return outputSample;
+    if (shaper.previous < 0){
+        for (int n = 0; n < count; n++)
+            x[n] = shaperCurve(curve, x[n]);
+    }
+    else{
+        // Crossfade from the tables of the previous setting
+        const Waveshaper &fading = shaper.slots[shaper.previous];
+        for (int n = 0; n < count; n++){
+            float in = x[n];
+            x[n] = shaper.fade * shaperCurve(curve, in) + (1.0f - shaper.fade) * shaperCurve(fading, in);
+        }
+    }
+#else
+    // Transfer characteristic constants
+    const float intensityFactor = ud->overdrive.a;
+    const float invNormalize    = ud->overdrive.scale;
+
+    for (int n = 0; n < count; n++){
+        float in = x[n];
+        x[n] = in / (intensityFactor + fabsf(in)) * invNormalize;
+    }
+#endif
 }
 
-// Callback Function
-void processBlock(const SAMPLE* in, SAMPLE* out,
-                     unsigned long framesPerBuffer,
-                     RtUserData* ud){
 
-    for(unsigned long i = 0; i < framesPerBuffer; i++){
-        float inL = *in++;
-        float inR = *in++;
-        float inFloatL = toFloat(inL);
-        float inFloatR = toFloat(inR);
-
-    	float outL = inFloatL;
-    	float outR = inFloatR;
-
-        // No effect
-        if (ud->effects->norm)
-            outL = inFloatL;
-
-        // Tremolo effect
-        else if (ud->effects->trem){
-            int j = (int)(ud->params->tremPhase * (ud->LUT_SIZE / (2.0f * M_PI))) & (ud->LUT_SIZE - 1);
-            float trem =    (1.0 - ud->params->TREM_DEPTH) + ud->params->TREM_DEPTH
-                                * (0.5 * (1.0 + ud->sineLUT[j]));
-            
-            ud->params->tremPhase += ud->tremIncrement;
-
-            if (ud->params->tremPhase >= 2.0 * M_PI) ud->params->tremPhase -= 2.0 * M_PI;
-        
-            outL = inFloatL * trem; 
+// Overdrive effect
+void processOverdrive(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    DriveState &overdrive = ud->overdrive;
+    const float tone     = overdrive.tone;
+    const float mix      = overdrive.mix;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        OversampleState &oversample = overdrive.oversample[ch];
+        memcpy(ud->dryBuffer, x, frames * sizeof(float));
+        oversampleAlign(oversample, ud->dryBuffer, frames);
+
+        // Apply transfer characteristic (at the oversampled rate)
+        for (unsigned long i = 0; i < frames; i += OVERSAMPLE_CHUNK){
+            int chunk = std::min(frames - i, (unsigned long)OVERSAMPLE_CHUNK);
+            float* shaped = oversampleUp(ud->oversampler, oversample, x + i, chunk);
+            shapeOverdrive(shaped, chunk * oversample.factor, ud);
+            oversampleDown(ud->oversampler, oversample, x + i, chunk);
         }
-        
-
-        // Delay effect
-        else if (ud->effects->delay){
-            float delayedSample = SAMPLE_SILENCE;
-
-            delayedSample = ud->delayBuffer[ud->delayIndex];
-
-            // store current input sample in delay buffer
-            ud->delayBuffer[ud->delayIndex] = inFloatL + delayedSample * ud->params->FEEDBACK;
-            
-            // Mix original and delayed signals
-            outL = (1.0 - ud->params->MIX) * inFloatL
-                        + ud->params->MIX * delayedSample;
-            
-            // Increment and wrap delay index
-            ud->delayIndex++;
-            if (ud->delayIndex >= ud->delaySize)
-                ud->delayIndex = 0;
+
+        applyToneFilter(x, frames, ud, overdrive.toneState[ch], tone);
+        clampAndMix(x, ud->dryBuffer, frames, mix);
+    }
+}
+
+
+// Distortion effect
+void processDistortion(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    DriveState &distortion = ud->distortion;
+    const float tone       = distortion.tone;
+    const float mix        = distortion.mix;
+    const float gain       = distortion.gain;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        OversampleState &oversample = distortion.oversample[ch];
+        memcpy(ud->dryBuffer, x, frames * sizeof(float));
+        oversampleAlign(oversample, ud->dryBuffer, frames);
+
+        // Apply transfer characteristic (hard clip, at the oversampled rate)
+        for (unsigned long i = 0; i < frames; i += OVERSAMPLE_CHUNK){
+            int chunk = std::min(frames - i, (unsigned long)OVERSAMPLE_CHUNK);
+            float* shaped = oversampleUp(ud->oversampler, oversample, x + i, chunk);
+            const int count = chunk * oversample.factor;
+
+            for (int n = 0; n < count; n++){
+                float distortedSample = gain * shaped[n];
+                if (distortedSample > 1.0f) distortedSample = 1.0f;
+                if (distortedSample < -1.0f) distortedSample = -1.0f;
+                shaped[n] = distortedSample;
+            }
+
+            oversampleDown(ud->oversampler, oversample, x + i, chunk);
         }
 
+        applyToneFilter(x, frames, ud, distortion.toneState[ch], tone);
+        clampAndMix(x, ud->dryBuffer, frames, mix);
+    }
+}
 
-        // Reverb
-        else if (ud->effects->reverb){
-            float outReverb = SAMPLE_SILENCE;
-	        float feedbackSum = SAMPLE_SILENCE;
 
-            for (int tap = 0; tap < AudioParams::REVERB_TAPS; tap++){
-                int j = (ud->reverbIndex[tap] + ud->reverbSize - ud->reverbDelay[tap]) % ud->reverbSize;
-                float delayedSample = ud->reverbBuffer[j];
-                outReverb += delayedSample * ud->reverbGain[tap];
+// Fuzz transfer characteristic over count samples. The bias follows the
+// average amplitude (sampleAvg), which is updated per sample.
+static void shapeFuzz(float* x, int count, float &sampleAvg, float invAttack, RtUserData* ud){
+    float avg = sampleAvg;
 
-                // update buffer with input + feedback
-                ud->reverbBuffer[ud->reverbIndex[tap]] = inFloatL + feedbackSum * ud->params->reverbDecay;
-	        }
+#if SHAPER_TABLES
+    // Tables for drive, factor and bias (see shaper.h)
+    const ShaperBank &shaper = ud->shapers[SHAPER_FUZZ];
+    const Waveshaper &curve = shaper.slots[shaper.current];
 
-            ud->reverbBuffer[ud->reverbIndex[0]] = inFloatL + feedbackSum * ud->params->reverbDecay;
+    if (shaper.previous < 0){
+        for (int n = 0; n < count; n++){
+            float in = x[n];
 
-            for (int tap = 0; tap < AudioParams::REVERB_TAPS; tap++){
-            ud->reverbIndex[tap]++;
-            if (ud->reverbIndex[tap] >= ud->reverbSize)
-                ud->reverbIndex[tap] = 0;
-            }
+            // Adjust average amplitude for reactive biasing
+            avg += (fminf(1.414f * fabsf(in), 1.0f) - avg) * invAttack;
 
-            outL = (1.0f - ud->params->MIX) * inFloatL + ud->params->MIX * outReverb;
-            }
+            // Apply transfer characteristic (biased by the average)
+            x[n] = shaperFuzz(curve, in, avg);
+        }
+    }
+    else{
+        // Crossfade from the tables of the previous setting
+        const Waveshaper &fading = shaper.slots[shaper.previous];
+        for (int n = 0; n < count; n++){
+            float in = x[n];
+            avg += (fminf(1.414f * fabsf(in), 1.0f) - avg) * invAttack;
+            x[n] = shaper.fade * shaperFuzz(curve, in, avg) + (1.0f - shaper.fade) * shaperFuzz(fading, in, avg);
+        }
+    }
+#else
+    const float drive      = ud->fuzz.drive;
+    const float maxBias    = ud->fuzz.maxBias;
+
+    const float intensityFactor = ud->fuzz.a;
+
+    for (int n = 0; n < count; n++){
+        float in = x[n];
+
+        // Adjust average amplitude for reactive biasing
+        avg += (fminf(1.414f * fabsf(in), 1.0f) - avg) * invAttack;
+        float biasFactor = maxBias * avg * drive;
+
+        // Apply transfer characteristic
+        float normalizeFactor;
+        if (in >= -biasFactor)
+            normalizeFactor = (1 + biasFactor) / (intensityFactor + fabsf(1 + biasFactor));
+        else
+            normalizeFactor = (1 - biasFactor) / (intensityFactor + fabsf(-1 + biasFactor));
+        float distortedSample = (in + biasFactor) / (intensityFactor + fabsf(in + biasFactor));
+        x[n] = distortedSample / normalizeFactor;
+    }
+#endif
 
-        // Bitcrush
-        else if (ud->effects->bitcrush) {
-            // Calculate number of samples to hold
-            float sampleCount = ud->params->SAMPLE_RATE / ud->params->DOWNSAMPLE_RATE;
+    sampleAvg = avg;
+}
 
-            // Perform downsampling
-            if (ud->bitcrushCount >= sampleCount) {
-                // If bitcrush counter exceeds sample count, decrement counter & store new sample
-                ud->bitcrushCount -= sampleCount;
-                ud->bitcrushSample = inFloatL;
-		        outL = inFloatL;
-            }
-            else{
-                ud->bitcrushCount++;
-                outL = ud->bitcrushSample;
-            }
-	
-            float outBitcrush = ud->bitcrushSample;
-            float step = ud->params->BITCRUSH_STEP;
-
-            // Perform quantization
-	        outBitcrush = roundf(outBitcrush / step) * step;
-	        // Apply mix amount
-            outL = (1.0f - ud->params->MIX) * inFloatL + ud->params->MIX * outBitcrush;
+
+// Fuzz effect
+void processFuzz(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    FuzzState &fuzz = ud->fuzz;
+    const float tone       = fuzz.tone;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        OversampleState &oversample = fuzz.oversample[ch];
+        float sampleAvg = fuzz.average[ch];
+
+        // The attack is counted at the oversampled rate
+        const float invAttack = 1.0f / (fuzz.attackFrames * oversample.factor);
+
+        // Waveshaper (at the oversampled rate)
+        for (unsigned long i = 0; i < frames; i += OVERSAMPLE_CHUNK){
+            int chunk = std::min(frames - i, (unsigned long)OVERSAMPLE_CHUNK);
+            float* shaped = oversampleUp(ud->oversampler, oversample, x + i, chunk);
+            shapeFuzz(shaped, chunk * oversample.factor, sampleAvg, invAttack, ud);
+            oversampleDown(ud->oversampler, oversample, x + i, chunk);
         }
 
-        // Overdrive
-        else if (ud->effects->overdrive) {
-            float outputSample = SAMPLE_SILENCE;
+        fuzz.average[ch] = sampleAvg;
 
-            // Apply effect and filters
-            float distortedSample = applyOverdrive(inFloatL, ud);
-            float filteredSample = applyToneFilter(distortedSample, ud,
-                                                ud->odToneBuffer,
-                                                ud->params->OD_TONE);
+        applyToneFilter(x, frames, ud, fuzz.toneState[ch], tone);
 
-            // Adjust for overflow
-            if (outputSample > 1.0f) outputSample = 1.0f;
-            else if (outputSample < 1.0f) outputSample = -1.0f;
+        // Remove the DC offset introduced by the bias
+        applyDCFilter(x, frames, ud, ch);
 
-            // Apply mix amount
-            outL = (1.0f - ud->params->MIX) * inFloatL + ud->params->MIX * outputSample;
+        // Adjust for overflow
+        for (unsigned long i = 0; i < frames; i++){
+            if (x[i] > 1.0f) x[i] = 1.0f;
+            else if (x[i] < -1.0f) x[i] = -1.0f;
         }
+    }
+}
 
-        // Distortion
-        else if (ud->effects->distortion) {
-            float outputSample = SAMPLE_SILENCE;
 
-            // Apply effect and filters
-            float distortedSample = applyDistortion(inFloatL, ud);
-            float filteredSample = applyToneFilter(distortedSample, ud, ud->distToneBuffer, ud->params->DIST_TONE);
-            outputSample = filteredSample;
+// Phaser effect
+void processPhaser(float* const* block, unsigned long frames, RtUserData* ud){
 
-            // Adjust for overflow
-            if (outputSample > 1.0f) outputSample = 1.0f;
-            else if (outputSample < -1.0f) outputSample = -1.0f;
+    // Effect parameters
+    PhaserState &phaser = ud->phaser;
+    const float mix      = phaser.mix;
+    const float feedback = phaser.feedback;
+    const float octaves  = phaser.octaves;
+    const float piOverRate = phaser.piOverRate;
+    const int stages = AudioParams::PHASER_STAGES;
+
+    // Allpass coefficient once every LFO_CONTROL_FRAMES frames, shared by
+    // every channel. The sweep is exponential so it moves evenly in pitch.
+    // A short last step only moves the LFO by the frames it covers, so the
+    // sweep rate does not depend on the block size.
+    float* coeffs = ud->scratchBuffer;
+    const unsigned long steps = (frames + LFO_CONTROL_FRAMES - 1) / LFO_CONTROL_FRAMES;
+    for (unsigned long k = 0; k < steps; k++){
+        float sweep = 0.5f * (1.0f + lfoValue(phaser.lfo));
+        float t = tanf(piOverRate * AudioParams::PHASER_MIN_HZ * exp2f(octaves * sweep));
+        coeffs[k] = (t - 1.0f) / (t + 1.0f);
+
+        unsigned long stepFrames = frames - k * LFO_CONTROL_FRAMES;
+        lfoAdvance(phaser.lfo, stepFrames < LFO_CONTROL_FRAMES ? stepFrames : LFO_CONTROL_FRAMES);
+    }
 
-            // Apply mix amount
-            outL = (1.0f - ud->params->MIX) * inFloatL + ud->params->MIX * outputSample;
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        float x1[AudioParams::PHASER_STAGES], y1[AudioParams::PHASER_STAGES];
+        for (int st = 0; st < stages; st++){
+            x1[st] = phaser.input[ch][st];
+            y1[st] = phaser.output[ch][st];
         }
+        float last = phaser.last[ch];
+
+        for (unsigned long i = 0; i < frames; i++){
+            const float a = coeffs[i / LFO_CONTROL_FRAMES];
+            float in = x[i];
+            float s = in + feedback * last;
+
+            // First order allpasses: y[n] = a x[n] + x[n-1] - a y[n-1]
+            for (int st = 0; st < stages; st++){
+                float y = a * s + x1[st] - a * y1[st];
+                x1[st] = s;
+                y1[st] = y;
+                s = y;
+            }
+            last = s;
 
-        // Fuzz
-        else if (ud->effects->fuzz) {
-            float outputSample = SAMPLE_SILENCE;
+            // Apply mix amount (the notches come from adding the dry signal)
+            x[i] = (1.0f - mix) * in + mix * s;
+        }
 
-            // Apply effect and filters
-            float distortedSample = applyFuzz(inFloatL, ud);
-            float filteredSample = applyToneFilter(distortedSample, ud, ud->fuzzToneBuffer, ud->params->FUZZ_TONE);
-            float dcFilteredSample = applyDCFilter(filteredSample, ud);
-            outputSample = dcFilteredSample;
+        for (int st = 0; st < stages; st++){
+            phaser.input[ch][st] = x1[st];
+            phaser.output[ch][st] = y1[st];
+        }
+        phaser.last[ch] = last;
+    }
+}
 
-            // Adjust for overflow
-            if (outputSample > 1.0f) outputSample = 1.0f;
-            else if (outputSample < -1.0f) outputSample = -1.0f;
 
-            outL = outputSample;
+// Chorus effect (a line per channel swept around CHORUS_DELAY_MS, odd
+// channels a quarter cycle apart for width)
+void processChorus(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    SweepState &chorus = ud->chorus;
+    const float mix    = chorus.mix;
+    const float centre = chorus.centre;
+    const float swing  = chorus.swing;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        float* wet = ud->scratchBuffer;
+        DelayTap tap;       // Lagrange reads keep no state
+
+        Lfo lfo = chorus.lfo;
+        if (ch & 1) lfo.phase += 1u << 30;
+        lfoRender(lfo, wet, frames);
+        for (unsigned long i = 0; i < frames; i++)
+            wet[i] = centre + swing * wet[i];
+
+        delayWriteBlock(chorus.lines[ch], x, frames);
+        delayReadBlock<DELAY_LAGRANGE>(chorus.lines[ch], wet, wet, frames, tap);
+
+        // Apply mix amount
+        for (unsigned long i = 0; i < frames; i++)
+            x[i] = (1.0f - mix) * x[i] + mix * wet[i];
+    }
+
+    lfoAdvance(chorus.lfo, frames);
+}
+
+
+// Flanger effect (short swept delay with feedback, read a sample at a time)
+void processFlanger(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    SweepState &flanger = ud->flanger;
+    const float mix      = flanger.mix;
+    const float feedback = flanger.feedback;
+    const float swing    = flanger.swing;
+    const float bottom   = flanger.centre;
+
+    // Delay curve for the block, shared by every channel
+    float* distance = ud->scratchBuffer;
+    lfoRender(flanger.lfo, distance, frames);
+    for (unsigned long i = 0; i < frames; i++)
+        distance[i] = bottom + swing * distance[i];
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        DelayLine &line = flanger.lines[ch];
+        DelayTap tap;       // Lagrange reads keep no state
+        float* x = block[ch];
+
+        for (unsigned long i = 0; i < frames; i++){
+            float in = x[i];
+            float delayed = delayRead<DELAY_LAGRANGE>(line, distance[i], tap);
+            delayWrite(line, in + feedback * delayed);
+
+            // Apply mix amount (the comb notches come from adding the dry signal)
+            x[i] = (1.0f - mix) * in + mix * delayed;
         }
+    }
+}
+
+
+// Vibrato effect (swept delay only, no dry signal: pitch modulation)
+void processVibrato(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    SweepState &vibrato = ud->vibrato;
+    const float swing  = vibrato.swing;
+    const float centre = vibrato.centre;
+
+    // Delay curve for the block, shared by every channel
+    float* delays = ud->scratchBuffer;
+    lfoRender(vibrato.lfo, delays, frames);
+    for (unsigned long i = 0; i < frames; i++)
+        delays[i] = centre + swing * delays[i];
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        DelayTap tap;       // Lagrange reads keep no state
+        delayWriteBlock(vibrato.lines[ch], block[ch], frames);
+        delayReadBlock<DELAY_LAGRANGE>(vibrato.lines[ch], delays, block[ch], frames, tap);
+    }
+}
+
+
+// Multi-tap delay effect
+void processMultitap(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    const float mix = ud->multitap.mix;
+
+    multitapProcess(ud->multitap.delay, block, ud->channels, frames, mix);
+}
+
+
+// Cabinet effect (convolution with the loaded impulse response)
+void processCabinet(float* const* block, unsigned long frames, RtUserData* ud){
+
+    // Effect parameters
+    CabinetState &cabinet = ud->cabinet;
+    const float mix = cabinet.mix;
+
+    // Nothing loaded: pass through
+    if (cabinet.convolver.filters.empty()) return;
+
+    for (int ch = 0; ch < ud->channels; ch++){
+        float* x = block[ch];
+        float* wet = ud->scratchBuffer;
+        convolverProcess(cabinet.convolver, ch, x, wet, frames);
+
+        // Apply mix amount
+        for (unsigned long i = 0; i < frames; i++)
+            x[i] = (1.0f - mix) * x[i] + mix * wet[i];
+    }
+}
+
+
+// Callback Function
+void processBlock(const void* in, void* out,
+                     unsigned long framesPerBuffer,
+                     RtUserData* ud){
+    AudioPathScope audioPath;
+
+    // Apply live parameter / chain changes at the block boundary
+    applyControl(ud);
+
+    // Resolve the effect chain (or the graph) once per block
+    EffectChain chain;
+    const EffectGraph* graph = NULL;
+    if (ud->graphs.active >= 0)
+        graph = &ud->graphs.graphs[ud->graphs.active];
+    else
+        buildChain(*ud->effects, chain);
+
+    const int channels = ud->channels;
+    const SampleFormat format = ud->format;
+    const unsigned long frameBytes = channels * sampleBytes(format);
+    const unsigned char* inBytes = (const unsigned char*)in;
+    unsigned char* outBytes = (unsigned char*)out;
+
+    float* block[AudioParams::MAX_CHANNELS];
+    for (int ch = 0; ch < channels; ch++)
+        block[ch] = ud->blockBuffer[ch];
+
+    while (framesPerBuffer > 0){
+        unsigned long frames = framesPerBuffer;
+        if (frames > (unsigned long)RtUserData::MAX_BLOCK_FRAMES)
+            frames = RtUserData::MAX_BLOCK_FRAMES;
+
+        // While a parameter is ramping, work in short sub-blocks so the
+        // effects (which read parameters once per call) follow the ramp
+        if (ud->activeRamps > 0 && frames > SMOOTH_FRAMES)
+            frames = SMOOTH_FRAMES;
+
+        // Deinterleave and convert to float once
+        deinterleaveFrames(inBytes, format, block, frames, channels);
+
+        if (graph)
+            graphRun(ud->graphRunner, *graph, block, frames, ud);
+        else
+            runChain(chain, block, frames, ud);
+
+        // Interleave and convert back once
+        interleaveFrames(block, outBytes, format, frames, channels);
 
-        else{
-            outL = inFloatL;
-	        outR = inFloatR;
-	    }
+        if (ud->activeRamps > 0)
+            advanceRamps(ud, frames);
 
-        *out++ = toSample(outL);
-        *out++ = toSample(outR);
+        inBytes += frames * frameBytes;
+        outBytes += frames * frameBytes;
+        framesPerBuffer -= frames;
     }
 }
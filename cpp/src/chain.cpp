@@ -0,0 +1,94 @@
+/*
+ * chain.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the effect chain
+*/
+
+#include "../include/chain.h"
+#include "../include/callback.h"
+
+// Processing function and name for each effect (indexed by EffectType)
+struct EffectInfo{
+    const char*   name;
+    EffectProcess process;
+};
+
+static const EffectInfo EFFECT_TABLE[NUM_EFFECTS] = {
+    {"No Effects", NULL},       // pass through, nothing to run
+    {"Tremolo",    processTremolo},
+    {"Delay",      processDelay},
+    {"Reverb",     processReverb},
+    {"Bitcrush",   processBitcrush},
+    {"Overdrive",  processOverdrive},
+    {"Distortion", processDistortion},
+    {"Fuzz",       processFuzz},
+    {"Cabinet",    processCabinet},
+    {"Phaser",     processPhaser},
+    {"Chorus",     processChorus},
+    {"Flanger",    processFlanger},
+    {"Vibrato",    processVibrato},
+    {"Multi-tap Delay", processMultitap},
+};
+
+
+const char* effectName(EffectType type){
+    if (type < 0 || type >= NUM_EFFECTS) return "Unknown";
+    return EFFECT_TABLE[type].name;
+}
+
+
+EffectProcess effectProcess(EffectType type){
+    if (type < 0 || type >= NUM_EFFECTS) return NULL;
+    return EFFECT_TABLE[type].process;
+}
+
+
+// Add one effect to the chain (skipping pass through)
+static void addNode(EffectChain &chain, EffectType type){
+    if (chain.length >= EffectChoices::MAX_CHAIN) return;
+    if (!EFFECT_TABLE[type].process) return;
+
+    chain.nodes[chain.length].type = type;
+    chain.nodes[chain.length].process = EFFECT_TABLE[type].process;
+    chain.length++;
+}
+
+
+// Build chain
+void buildChain(const EffectChoices &effectChoice, EffectChain &chain){
+    chain.length = 0;
+
+    // Chosen order
+    if (effectChoice.chainLength > 0){
+        for (int i = 0; i < effectChoice.chainLength; i++)
+            addNode(chain, effectChoice.chain[i]);
+        return;
+    }
+
+    // No order recorded: use menu order of the set flags
+    if (effectChoice.norm)       addNode(chain, EFFECT_NORM);
+    if (effectChoice.trem)       addNode(chain, EFFECT_TREM);
+    if (effectChoice.delay)      addNode(chain, EFFECT_DELAY);
+    if (effectChoice.reverb)     addNode(chain, EFFECT_REVERB);
+    if (effectChoice.bitcrush)   addNode(chain, EFFECT_BITCRUSH);
+    if (effectChoice.overdrive)  addNode(chain, EFFECT_OVERDRIVE);
+    if (effectChoice.distortion) addNode(chain, EFFECT_DISTORTION);
+    if (effectChoice.fuzz)       addNode(chain, EFFECT_FUZZ);
+    if (effectChoice.cabinet)    addNode(chain, EFFECT_CABINET);
+    if (effectChoice.phaser)     addNode(chain, EFFECT_PHASER);
+    if (effectChoice.chorus)     addNode(chain, EFFECT_CHORUS);
+    if (effectChoice.flanger)    addNode(chain, EFFECT_FLANGER);
+    if (effectChoice.vibrato)    addNode(chain, EFFECT_VIBRATO);
+    if (effectChoice.multitap)   addNode(chain, EFFECT_MULTITAP);
+}
+
+
+// Run chain
+void runChain(const EffectChain &chain, float* const* block, unsigned long frames, RtUserData* ud){
+    for (int i = 0; i < chain.length; i++)
+        chain.nodes[i].process(block, frames, ud);
+}
@@ -0,0 +1,519 @@
+/*
+ * control.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of live parameter control
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include "../include/control.h"
+#include "../include/menu.h"
+#include "../include/preset.h"
+
+// Parameter table (indexed by ParamId)
+struct ParamInfo{
+    const char* name;
+    float AudioParams::*value;
+    float min;
+    float max;
+};
+
+static const ParamInfo PARAM_TABLE[NUM_PARAMS] = {
+    {"mix",           &AudioParams::MIX,           0.0f,  1.0f},
+    {"trem_freq",     &AudioParams::TREM_FREQ,     0.0f,  50.0f},
+    {"trem_depth",    &AudioParams::TREM_DEPTH,    0.0f,  1.0f},
+    {"od_drive",      &AudioParams::OD_DRIVE,      0.0f,  10.0f},
+    {"od_tone",       &AudioParams::OD_TONE,       0.0f,  1.0f},
+    {"od_factor",     &AudioParams::OD_FACTOR,     0.0f,  100.0f},
+    {"dist_drive",    &AudioParams::DIST_DRIVE,    0.0f,  10.0f},
+    {"dist_tone",     &AudioParams::DIST_TONE,     0.0f,  1.0f},
+    {"dist_factor",   &AudioParams::DIST_FACTOR,   1.0f,  100.0f},
+    {"fuzz_drive",    &AudioParams::FUZZ_DRIVE,    0.0f,  10.0f},
+    {"fuzz_tone",     &AudioParams::FUZZ_TONE,     0.0f,  1.0f},
+    {"fuzz_factor",   &AudioParams::FUZZ_FACTOR,   0.0f,  100.0f},
+    {"fuzz_max_bias", &AudioParams::FUZZ_MAX_BIAS, -1.0f, 1.0f},
+    {"dc_mix",        &AudioParams::DC_MIX,        0.0f,  1.0f},
+    {"reverb_time",   &AudioParams::REVERB_TIME,   0.1f,  20.0f},
+    {"reverb_damping",&AudioParams::REVERB_DAMPING,0.0f,  0.99f},
+    {"conv_mix",      &AudioParams::CONV_MIX,      0.0f,  1.0f},
+    {"phaser_rate",   &AudioParams::PHASER_RATE,   0.01f, 20.0f},
+    {"phaser_depth",  &AudioParams::PHASER_DEPTH,  0.0f,  1.0f},
+    {"phaser_feedback",&AudioParams::PHASER_FEEDBACK,-0.95f,0.95f},
+    {"delay_ms",      &AudioParams::DELAY_MS,      1.0f,  AudioParams::DELAY_MAX_MS},
+    {"chorus_rate",   &AudioParams::CHORUS_RATE,   0.01f, 20.0f},
+    {"chorus_depth",  &AudioParams::CHORUS_DEPTH,  0.0f,  15.0f},
+    {"flanger_rate",  &AudioParams::FLANGER_RATE,  0.01f, 20.0f},
+    {"flanger_depth", &AudioParams::FLANGER_DEPTH, 0.0f,  10.0f},
+    {"flanger_feedback",&AudioParams::FLANGER_FEEDBACK,-0.95f,0.95f},
+    {"vibrato_rate",  &AudioParams::VIBRATO_RATE,  0.01f, 20.0f},
+    {"vibrato_depth", &AudioParams::VIBRATO_DEPTH, 0.0f,  10.0f},
+    {"delay_feedback",&AudioParams::FEEDBACK,      0.0f,  0.95f},
+    {"tap_bpm",       &AudioParams::TAP_BPM,       20.0f, 300.0f},
+};
+
+
+const char* paramName(ParamId param){
+    if (param < 0 || param >= NUM_PARAMS) return "unknown";
+    return PARAM_TABLE[param].name;
+}
+
+ParamId paramByName(const std::string &name){
+    for (int i = 0; i < NUM_PARAMS; i++)
+        if (name == PARAM_TABLE[i].name) return (ParamId)i;
+    return NUM_PARAMS;
+}
+
+// Clamp a value to the range of its parameter
+static float clampParam(ParamId param, float value){
+    const ParamInfo &info = PARAM_TABLE[param];
+    if (value < info.min) value = info.min;
+    if (value > info.max) value = info.max;
+    return value;
+}
+
+void paramSet(AudioParams &audioParams, ParamId param, float value){
+    if (param < 0 || param >= NUM_PARAMS) return;
+    audioParams.*PARAM_TABLE[param].value = clampParam(param, value);
+}
+
+
+// ---------------------------------------------------------------------------
+// Control side
+// ---------------------------------------------------------------------------
+
+// Push one command (single producer)
+static bool pushCommand(CommandQueue &queue, const ControlCommand &command){
+    unsigned head = queue.head.load(std::memory_order_relaxed);
+    unsigned tail = queue.tail.load(std::memory_order_acquire);
+    if (head - tail >= CommandQueue::CAPACITY) return false;
+
+    queue.slots[head & (CommandQueue::CAPACITY - 1)] = command;
+    queue.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// Whether count more commands fit (single producer: the room can only grow
+// until it pushes)
+static bool queueRoom(const CommandQueue &queue, unsigned count){
+    unsigned head = queue.head.load(std::memory_order_relaxed);
+    unsigned tail = queue.tail.load(std::memory_order_acquire);
+    return head - tail + count <= CommandQueue::CAPACITY;
+}
+
+#if SHAPER_TABLES
+// Rebuild the waveshaper tables a parameter feeds (control side) into a
+// free slot and fill in the command that switches to them (slot -1 if the
+// parameter feeds no table), keeping the settings it replaced in previous.
+// Returns false if no slot is free.
+static bool buildShaper(RtUserData &ud, ParamId param, float value, ControlCommand &command,
+                        ShaperSettings &previous){
+    command.type = ControlCommand::SET_SHAPER;
+    command.slot = -1;
+    value = clampParam(param, value);
+
+    ShaperId id;
+    if (param == PARAM_OD_DRIVE || param == PARAM_OD_FACTOR) id = SHAPER_OD;
+    else if (param == PARAM_FUZZ_DRIVE || param == PARAM_FUZZ_FACTOR || param == PARAM_FUZZ_MAX_BIAS) id = SHAPER_FUZZ;
+    else return true;
+
+    ShaperBank &bank = ud.shapers[id];
+    previous = bank.settings;
+    ShaperSettings settings = bank.settings;
+    if (param == PARAM_OD_DRIVE || param == PARAM_FUZZ_DRIVE) settings.drive = value;
+    else if (param == PARAM_OD_FACTOR || param == PARAM_FUZZ_FACTOR) settings.factor = value;
+    else settings.maxBias = value;
+
+    command.shaper = id;
+    command.slot = shaperBuild(bank, id, settings);
+    return command.slot >= 0;
+}
+#endif
+
+bool sendParam(RtUserData &ud, ParamId param, float value){
+    if (param < 0 || param >= NUM_PARAMS) return false;
+
+    ControlCommand command = {};
+    command.type = ControlCommand::SET_PARAM;
+    command.param = param;
+    command.value = value;
+
+    // The tables first: the parameter is only queued together with them
+    ControlCommand shaper = {};
+    shaper.slot = -1;
+#if SHAPER_TABLES
+    ShaperSettings previous;
+    if (!buildShaper(ud, param, value, shaper, previous)){
+        fprintf(stderr, "No free shaper slot\n");
+        return false;
+    }
+#endif
+
+    if (!queueRoom(ud.commands, shaper.slot >= 0 ? 2 : 1)){
+#if SHAPER_TABLES
+        if (shaper.slot >= 0){
+            ShaperBank &bank = ud.shapers[shaper.shaper];
+            slotCancel(bank.pool, shaper.slot);
+            bank.settings = previous;
+        }
+#endif
+        fprintf(stderr, "Control queue full\n");
+        return false;
+    }
+    pushCommand(ud.commands, command);
+    if (shaper.slot >= 0) pushCommand(ud.commands, shaper);
+    return true;
+}
+
+bool sendChain(RtUserData &ud, const EffectChoices &effectChoice){
+    ControlCommand command = {};
+    command.type = ControlCommand::SET_CHAIN;
+    command.chainLength = effectChoice.chainLength;
+    for (int i = 0; i < effectChoice.chainLength; i++)
+        command.chain[i] = effectChoice.chain[i];
+    return pushCommand(ud.commands, command);
+}
+
+bool sendTaps(RtUserData &ud, const TapPattern &pattern){
+    ControlCommand command = {};
+    command.type = ControlCommand::SET_TAPS;
+    command.taps = pattern;
+    return pushCommand(ud.commands, command);
+}
+
+bool sendGraph(RtUserData &ud, const std::string &spec){
+    int slot = graphBuild(ud.graphs, spec);
+    if (slot < 0) return false;
+
+    ControlCommand command = {};
+    command.type = ControlCommand::SET_GRAPH;
+    command.slot = slot;
+    if (!pushCommand(ud.commands, command)){
+        slotCancel(ud.graphs.pool, slot);
+        fprintf(stderr, "Control queue full\n");
+        return false;
+    }
+    return true;
+}
+
+// Free the slots a preset command would have played
+static void releasePreset(RtUserData &ud, const ControlCommand &command){
+    if (command.slot >= 0) slotCancel(ud.graphs.pool, command.slot);
+    for (int id = 0; id < NUM_SHAPERS; id++)
+        if (command.shapers[id] >= 0)
+            slotCancel(ud.shapers[id].pool, command.shapers[id]);
+}
+
+bool sendPreset(RtUserData &ud, const Preset &preset){
+    ControlCommand command = {};
+    command.type = ControlCommand::SET_PRESET;
+    command.preset = &preset;
+    command.slot = -1;
+    for (int id = 0; id < NUM_SHAPERS; id++) command.shapers[id] = -1;
+
+    if (preset.graph[0] != '\0'){
+        command.slot = graphBuild(ud.graphs, preset.graph);
+        if (command.slot < 0) return false;
+    }
+
+#if SHAPER_TABLES
+    // Tables for the drive, factor and bias the preset sets
+    for (int id = 0; id < NUM_SHAPERS; id++){
+        const ParamId drive = id == SHAPER_OD ? PARAM_OD_DRIVE : PARAM_FUZZ_DRIVE;
+        const ParamId factor = id == SHAPER_OD ? PARAM_OD_FACTOR : PARAM_FUZZ_FACTOR;
+        const bool hasBias = id == SHAPER_FUZZ;
+        const uint32_t mask = 1u << drive | 1u << factor | (hasBias ? 1u << PARAM_FUZZ_MAX_BIAS : 0);
+        if (!(preset.paramMask & mask)) continue;
+
+        ShaperBank &bank = ud.shapers[id];
+        ShaperSettings settings = bank.settings;
+        if (preset.paramMask & 1u << drive) settings.drive = clampParam(drive, preset.params[drive]);
+        if (preset.paramMask & 1u << factor) settings.factor = clampParam(factor, preset.params[factor]);
+        if (hasBias && preset.paramMask & 1u << PARAM_FUZZ_MAX_BIAS)
+            settings.maxBias = clampParam(PARAM_FUZZ_MAX_BIAS, preset.params[PARAM_FUZZ_MAX_BIAS]);
+
+        command.shapers[id] = shaperBuild(bank, (ShaperId)id, settings);
+        if (command.shapers[id] < 0){
+            releasePreset(ud, command);
+            return false;
+        }
+    }
+#endif
+
+    if (!pushCommand(ud.commands, command)){
+        releasePreset(ud, command);
+        fprintf(stderr, "Control queue full\n");
+        return false;
+    }
+    return true;
+}
+
+bool sendControlLine(RtUserData &ud, const std::string &line){
+    std::istringstream words(line);
+    std::string name, value;
+    words >> name >> value;
+
+    if (name == "chain"){
+        EffectChoices effectChoice;
+        bool validChoice = false;
+        bool exitFlag = false;
+        if (value.find('0') == std::string::npos)
+            chainSelect(value, effectChoice, validChoice, exitFlag);
+        if (!validChoice){
+            fprintf(stderr, "Invalid chain: %s\n", value.c_str());
+            return false;
+        }
+        if (!sendChain(ud, effectChoice)){
+            fprintf(stderr, "Control queue full\n");
+            return false;
+        }
+        return true;
+    }
+
+    if (name == "graph")
+        return sendGraph(ud, value);
+
+    if (name == "taps"){
+        TapPattern pattern;
+        if (multitapParse(value, pattern) < 0) return false;
+        if (!sendTaps(ud, pattern)){
+            fprintf(stderr, "Control queue full\n");
+            return false;
+        }
+        return true;
+    }
+
+    if (name == "preset"){
+        const Preset* preset = ud.presets ? presetFind(*ud.presets, value) : NULL;
+        if (!preset){
+            fprintf(stderr, "No preset %s\n", value.c_str());
+            return false;
+        }
+        return sendPreset(ud, *preset);
+    }
+
+    ParamId param = paramByName(name);
+    char* end = NULL;
+    float number = strtof(value.c_str(), &end);
+    if (param == NUM_PARAMS || value.empty() || *end != '\0'){
+        fprintf(stderr, "Unknown command: %s\n", line.c_str());
+        return false;
+    }
+    return sendParam(ud, param, number);
+}
+
+void printControlHelp(){
+    printf("Live control: type a command and press ENTER\n");
+    printf("  <param> <value>   e.g. \"mix 0.7\"\n");
+    printf("  chain <effects>   e.g. \"chain 834\" (menu keys, in order)\n");
+    printf("  graph <routing>   e.g. \"graph 6[|3:0.5|4:0.5]\" (menu keys in series; [a|b] runs\n");
+    printf("                    branches side by side and mixes them, :gain per branch, empty = dry)\n");
+    printf("  taps <pattern>    multi-tap delay, e.g. \"taps 1/4:0.8:-0.5:0.3,1/8.:0.6:0.5\"\n");
+    printf("                    (time[:gain[:pan[:feedback[:damping]]]], time in ms or 1/8, 1/8., 1/8t)\n");
+    printf("  preset <name>     switch to a preset of the --presets bank\n");
+    printf("  params:");
+    for (int i = 0; i < NUM_PARAMS; i++)
+        printf(" %s", PARAM_TABLE[i].name);
+    printf("\n");
+}
+
+
+// ---------------------------------------------------------------------------
+// Audio side
+// ---------------------------------------------------------------------------
+
+void snapshotParams(RtUserData* ud){
+    const AudioParams &params = *ud->params;
+    const float toSamples = params.SAMPLE_RATE / 1000.0f;
+
+    ud->trem.depth = params.TREM_DEPTH;
+
+    ud->delay.feedback = params.FEEDBACK;
+    ud->delay.mix = params.MIX;
+
+    ud->reverb.mix = params.MIX;
+
+    ud->bitcrush.mix = params.MIX;
+    ud->bitcrush.hold = params.SAMPLE_RATE / params.DOWNSAMPLE_RATE;
+
+    DriveState &overdrive = ud->overdrive;
+    overdrive.tone = params.OD_TONE;
+    overdrive.mix = params.MIX;
+    overdrive.a = 1 / (params.OD_FACTOR*params.OD_DRIVE + 0.01);
+    const float normalize = 1 / (overdrive.a + 1);
+    overdrive.scale = 1 / normalize;
+
+    DriveState &distortion = ud->distortion;
+    distortion.tone = params.DIST_TONE;
+    distortion.mix = params.MIX;
+    distortion.gain = 1 + (params.DIST_FACTOR-1)*params.DIST_DRIVE;
+
+    FuzzState &fuzz = ud->fuzz;
+    fuzz.tone = params.FUZZ_TONE;
+    fuzz.a = 1 / (params.FUZZ_FACTOR*params.FUZZ_DRIVE + 0.01);
+    fuzz.drive = params.FUZZ_DRIVE;
+    fuzz.maxBias = params.FUZZ_MAX_BIAS;
+    fuzz.dcPole = params.DC_POLE_COEFFICENT;
+    fuzz.dcMix = params.DC_MIX;
+
+    ud->cabinet.mix = params.CONV_MIX;
+
+    PhaserState &phaser = ud->phaser;
+    phaser.mix = params.MIX;
+    phaser.feedback = params.PHASER_FEEDBACK;
+    phaser.octaves = params.PHASER_DEPTH * log2f(AudioParams::PHASER_MAX_HZ / AudioParams::PHASER_MIN_HZ);
+    phaser.piOverRate = AudioParams::PI / params.SAMPLE_RATE;
+
+    SweepState &chorus = ud->chorus;
+    chorus.mix = params.MIX;
+    chorus.centre = AudioParams::CHORUS_DELAY_MS * toSamples;
+    chorus.swing = 0.5f * params.CHORUS_DEPTH * toSamples;
+
+    SweepState &flanger = ud->flanger;
+    flanger.mix = params.MIX;
+    flanger.feedback = params.FLANGER_FEEDBACK;
+    flanger.swing = 0.5f * params.FLANGER_DEPTH * toSamples;
+    flanger.centre = AudioParams::FLANGER_MIN_MS * toSamples + flanger.swing;
+
+    SweepState &vibrato = ud->vibrato;
+    vibrato.swing = 0.5f * params.VIBRATO_DEPTH * params.SAMPLE_RATE / 1000.0f;
+    vibrato.centre = 1.0f + vibrato.swing;      // at least a sample behind, for the Lagrange points
+
+    ud->multitap.mix = params.MIX;
+}
+
+// Values computed from parameters (besides the snapshot)
+static void updateDerived(RtUserData* ud, ParamId param){
+    if (param == PARAM_TREM_FREQ)
+        lfoSetRate(ud->trem.lfo, ud->params->TREM_FREQ, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_PHASER_RATE)
+        lfoSetRate(ud->phaser.lfo, ud->params->PHASER_RATE, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_CHORUS_RATE)
+        lfoSetRate(ud->chorus.lfo, ud->params->CHORUS_RATE, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_FLANGER_RATE)
+        lfoSetRate(ud->flanger.lfo, ud->params->FLANGER_RATE, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_VIBRATO_RATE)
+        lfoSetRate(ud->vibrato.lfo, ud->params->VIBRATO_RATE, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_TAP_BPM)
+        multitapSetTempo(ud->multitap.delay, ud->ramps[param].target);      // crossfaded to, not swept through
+    else if (param == PARAM_DELAY_MS)       // crossfaded to, not swept through
+        ud->delay.target = delayDistance(ud->ramps[param].target, ud->params->SAMPLE_RATE);
+    else if (param == PARAM_REVERB_TIME || param == PARAM_REVERB_DAMPING)
+        fdnSetDecay(ud->reverb.fdn, ud->params->REVERB_TIME, ud->params->REVERB_DAMPING, ud->params->SAMPLE_RATE);
+}
+
+// Start (or restart) the ramp of one parameter
+static void startRamp(RtUserData* ud, ParamId param, float target){
+    const ParamInfo &info = PARAM_TABLE[param];
+    target = clampParam(param, target);
+
+    const int rampFrames = SMOOTH_MS * ud->params->SAMPLE_RATE / 1000;
+    float current = ud->params->*info.value;
+
+    ParamRamp &ramp = ud->ramps[param];
+    if (ramp.remaining == 0) ud->activeRamps++;
+    ramp.target = target;
+    ramp.step = (target - current) / rampFrames;
+    ramp.remaining = rampFrames;
+}
+
+// Play a chain (it replaces the graph)
+static void setChain(RtUserData* ud, const EffectType* chain, int chainLength){
+    graphSwitch(ud->graphs, -1);
+
+    // The audio path owns the effect choices while streaming
+    EffectChoices* effects = ud->effects;
+    *effects = EffectChoices();
+    bool EffectChoices::*flags[NUM_EFFECTS] = {
+        &EffectChoices::norm, &EffectChoices::trem, &EffectChoices::delay,
+        &EffectChoices::reverb, &EffectChoices::bitcrush, &EffectChoices::overdrive,
+        &EffectChoices::distortion, &EffectChoices::fuzz, &EffectChoices::cabinet,
+        &EffectChoices::phaser, &EffectChoices::chorus, &EffectChoices::flanger,
+        &EffectChoices::vibrato, &EffectChoices::multitap
+    };
+    for (int i = 0; i < chainLength; i++){
+        effects->chain[i] = chain[i];
+        effects->*flags[chain[i]] = true;
+    }
+    effects->chainLength = chainLength;
+}
+
+// Switch to a preset: routing and taps at once, tables and parameters glide
+static void setPreset(RtUserData* ud, const ControlCommand &command){
+    const Preset &preset = *command.preset;
+    const int rampFrames = SMOOTH_MS * ud->params->SAMPLE_RATE / 1000;
+
+    if (preset.chainLength >= 0){
+        EffectType chain[EffectChoices::MAX_CHAIN];
+        for (int i = 0; i < preset.chainLength; i++)
+            chain[i] = (EffectType)preset.chain[i];
+        setChain(ud, chain, preset.chainLength);
+    }
+    if (command.slot >= 0)
+        graphSwitch(ud->graphs, command.slot);
+    if (preset.hasTaps)
+        multitapSetPattern(ud->multitap.delay, preset.taps);
+
+    for (int id = 0; id < NUM_SHAPERS; id++)
+        if (command.shapers[id] >= 0)
+            shaperSwitch(ud->shapers[id], command.shapers[id], rampFrames);
+    for (int p = 0; p < NUM_PARAMS; p++)
+        if (preset.paramMask & 1u << p)
+            startRamp(ud, (ParamId)p, preset.params[p]);
+}
+
+void applyControl(RtUserData* ud){
+    CommandQueue &queue = ud->commands;
+    unsigned tail = queue.tail.load(std::memory_order_relaxed);
+    unsigned head = queue.head.load(std::memory_order_acquire);
+
+    for (; tail != head; tail++){
+        const ControlCommand &command = queue.slots[tail & (CommandQueue::CAPACITY - 1)];
+
+        if (command.type == ControlCommand::SET_PARAM)
+            startRamp(ud, command.param, command.value);
+        else if (command.type == ControlCommand::SET_TAPS)
+            multitapSetPattern(ud->multitap.delay, command.taps);
+        else if (command.type == ControlCommand::SET_SHAPER)
+            shaperSwitch(ud->shapers[command.shaper], command.slot, SMOOTH_MS * ud->params->SAMPLE_RATE / 1000);
+        else if (command.type == ControlCommand::SET_GRAPH)
+            graphSwitch(ud->graphs, command.slot);
+        else if (command.type == ControlCommand::SET_PRESET)
+            setPreset(ud, command);
+        else
+            setChain(ud, command.chain, command.chainLength);
+    }
+
+    queue.tail.store(tail, std::memory_order_release);
+}
+
+void advanceRamps(RtUserData* ud, unsigned long frames){
+    for (int i = 0; i < NUM_SHAPERS; i++)
+        shaperAdvance(ud->shapers[i], frames);
+    if (ud->activeRamps == 0) return;
+
+    for (int i = 0; i < NUM_PARAMS && ud->activeRamps > 0; i++){
+        ParamRamp &ramp = ud->ramps[i];
+        if (ramp.remaining == 0) continue;
+
+        float &value = ud->params->*PARAM_TABLE[i].value;
+        if ((unsigned long)ramp.remaining <= frames){
+            value = ramp.target;
+            ramp.remaining = 0;
+            ud->activeRamps--;
+        }
+        else{
+            value += ramp.step * frames;
+            ramp.remaining -= frames;
+        }
+        updateDerived(ud, (ParamId)i);
+    }
+
+    // The effects see the moved values from the next block on
+    snapshotParams(ud);
+}
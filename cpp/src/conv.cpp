@@ -0,0 +1,204 @@
+/*
+ * conv.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the convolution engine
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "../include/conv.h"
+#include "../include/wavfile.h"
+
+#define CONV_BINS (CONV_PARTITION + 1)
+
+
+int loadImpulseResponse(const char* path, ImpulseResponse &ir){
+    AudioFile file;
+    if (readAudioFile(path, file) < 0) return -1;
+    if (file.samples.empty() || file.sampleRate <= 0){
+        fprintf(stderr, "Impulse response %s is empty\n", path);
+        return -1;
+    }
+
+    ir.channels = file.channels;
+    ir.sampleRate = file.sampleRate;
+    ir.samples.resize(file.samples.size());
+    for (size_t i = 0; i < file.samples.size(); i++)
+        ir.samples[i] = file.samples[i] / 32768.0f;
+    return 0;
+}
+
+
+// One channel of the impulse response at the stream rate (linear interpolation)
+static std::vector<float> resampleChannel(const ImpulseResponse &ir, int channel, int sampleRate){
+    const size_t inFrames = ir.samples.size() / ir.channels;
+    const double ratio = (double)ir.sampleRate / sampleRate;
+
+    size_t outFrames = (size_t)(inFrames / ratio);
+    outFrames = std::min(outFrames, (size_t)CONV_MAX_SECONDS * sampleRate);
+
+    std::vector<float> out(outFrames);
+    for (size_t i = 0; i < outFrames; i++){
+        double position = i * ratio;
+        size_t j = (size_t)position;
+        float frac = (float)(position - j);
+        float a = ir.samples[j * ir.channels + channel];
+        float b = j + 1 < inFrames ? ir.samples[(j + 1) * ir.channels + channel] : 0.0f;
+        out[i] = a + frac * (b - a);
+    }
+    return out;
+}
+
+
+void convolverInit(Convolver &conv, const ImpulseResponse &ir, int sampleRate, int channels){
+    conv.filters.clear();
+    conv.states.clear();
+    if (ir.samples.empty() || ir.channels <= 0) return;
+
+    fftInit(conv.plan, 2 * CONV_PARTITION);
+    conv.accRe.assign(CONV_BINS, 0.0f);
+    conv.accIm.assign(CONV_BINS, 0.0f);
+    conv.time.assign(2 * CONV_PARTITION, 0.0f);
+
+    std::vector< std::vector<float> > taps(ir.channels);
+    double energy = 0.0;
+    for (int c = 0; c < ir.channels; c++){
+        taps[c] = resampleChannel(ir, c, sampleRate);
+        double channelEnergy = 0.0;
+        for (size_t i = 0; i < taps[c].size(); i++)
+            channelEnergy += (double)taps[c][i] * taps[c][i];
+        energy = std::max(energy, channelEnergy);
+    }
+
+    // Unit energy: white noise in, same level out
+    const float gain = energy > 0.0 ? (float)(1.0 / sqrt(energy)) : 0.0f;
+
+    conv.filters.resize(ir.channels);
+    for (int c = 0; c < ir.channels; c++){
+        std::vector<float> &h = taps[c];
+        for (size_t i = 0; i < h.size(); i++) h[i] *= gain;
+
+        ConvFilter &filter = conv.filters[c];
+        const int length = (int)h.size();
+        firSetCoefficients(filter.head, h.data(), std::min(length, CONV_PARTITION));
+
+        // Tail partitions, each zero padded to the FFT size
+        filter.partitions = std::max(0, (length - CONV_PARTITION + CONV_PARTITION - 1) / CONV_PARTITION);
+        filter.re.assign((size_t)filter.partitions * CONV_BINS, 0.0f);
+        filter.im.assign((size_t)filter.partitions * CONV_BINS, 0.0f);
+
+        for (int p = 0; p < filter.partitions; p++){
+            std::fill(conv.time.begin(), conv.time.end(), 0.0f);
+            const int start = CONV_PARTITION * (p + 1);
+            const int count = std::min(CONV_PARTITION, length - start);
+            std::copy(h.begin() + start, h.begin() + start + count, conv.time.begin());
+            fftRealForward(conv.plan, conv.time.data(),
+                           filter.re.data() + p * CONV_BINS, filter.im.data() + p * CONV_BINS);
+        }
+    }
+
+    conv.states.resize(channels);
+    for (int ch = 0; ch < channels; ch++){
+        const ConvFilter &filter = conv.filters[ch % ir.channels];
+        conv.states[ch].delayRe.assign((size_t)filter.partitions * CONV_BINS, 0.0f);
+        conv.states[ch].delayIm.assign((size_t)filter.partitions * CONV_BINS, 0.0f);
+    }
+    convolverReset(conv);
+}
+
+
+void convolverReset(Convolver &conv){
+    for (size_t ch = 0; ch < conv.states.size(); ch++){
+        ConvState &state = conv.states[ch];
+        firReset(state.head);
+        std::fill(state.delayRe.begin(), state.delayRe.end(), 0.0f);
+        std::fill(state.delayIm.begin(), state.delayIm.end(), 0.0f);
+        state.delayIndex = 0;
+        std::fill(state.window, state.window + 2 * CONV_PARTITION, 0.0f);
+        std::fill(state.output, state.output + CONV_PARTITION, 0.0f);
+        state.position = 0;
+    }
+}
+
+
+// A full input partition is in the window: push its spectrum into the delay
+// line and compute the next partition of tail output
+static void convolvePartition(Convolver &conv, const ConvFilter &filter, ConvState &state){
+    const int partitions = filter.partitions;
+
+    state.delayIndex = state.delayIndex + 1 < partitions ? state.delayIndex + 1 : 0;
+    float* newestRe = state.delayRe.data() + state.delayIndex * CONV_BINS;
+    float* newestIm = state.delayIm.data() + state.delayIndex * CONV_BINS;
+    fftRealForward(conv.plan, state.window, newestRe, newestIm);
+
+    // Y = sum over partitions p of X[now - p] * H[p]
+    float* accRe = conv.accRe.data();
+    float* accIm = conv.accIm.data();
+    std::fill(accRe, accRe + CONV_BINS, 0.0f);
+    std::fill(accIm, accIm + CONV_BINS, 0.0f);
+
+    int slot = state.delayIndex;
+    for (int p = 0; p < partitions; p++){
+        const float* xRe = state.delayRe.data() + slot * CONV_BINS;
+        const float* xIm = state.delayIm.data() + slot * CONV_BINS;
+        const float* hRe = filter.re.data() + p * CONV_BINS;
+        const float* hIm = filter.im.data() + p * CONV_BINS;
+
+        for (int k = 0; k < CONV_BINS; k++){
+            accRe[k] += xRe[k] * hRe[k] - xIm[k] * hIm[k];
+            accIm[k] += xRe[k] * hIm[k] + xIm[k] * hRe[k];
+        }
+
+        slot = slot > 0 ? slot - 1 : partitions - 1;
+    }
+
+    // Overlap-save: the second half of the inverse is the linear convolution
+    fftRealInverse(conv.plan, accRe, accIm, conv.time.data());
+    memcpy(state.output, conv.time.data() + CONV_PARTITION, CONV_PARTITION * sizeof(float));
+
+    // This partition becomes the previous one
+    memcpy(state.window, state.window + CONV_PARTITION, CONV_PARTITION * sizeof(float));
+}
+
+
+void convolverProcess(Convolver &conv, int channel, const float* in, float* out,
+                      unsigned long frames){
+    if (conv.filters.empty()){
+        memcpy(out, in, frames * sizeof(float));
+        return;
+    }
+
+    const ConvFilter &filter = conv.filters[channel % conv.filters.size()];
+    ConvState &state = conv.states[channel];
+
+    // Head: direct FIR, no latency
+    firProcess(filter.head, state.head, in, out, frames);
+    if (filter.partitions == 0) return;
+
+    // Tail: play out the last computed partition while collecting the next
+    unsigned long i = 0;
+    while (i < frames){
+        unsigned long run = std::min(frames - i, (unsigned long)(CONV_PARTITION - state.position));
+        const float* tail = state.output + state.position;
+        float* current = state.window + CONV_PARTITION + state.position;
+
+        for (unsigned long n = 0; n < run; n++){
+            out[i + n] += tail[n];
+            current[n] = in[i + n];
+        }
+
+        state.position += run;
+        i += run;
+
+        if (state.position == CONV_PARTITION){
+            convolvePartition(conv, filter, state);
+            state.position = 0;
+        }
+    }
+}
@@ -0,0 +1,441 @@
+/*
+ * convert.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of block sample <-> float conversion
+ *
+ * NOTE: Mono and stereo have SIMD kernels; other channel counts use the
+ * scalar path. Results are bit exact with toFloat / toSample for every
+ * finite input (NaN saturates to -1 in the SIMD kernels instead of being
+ * undefined).
+*/
+
+#include "../include/convert.h"
+#include "../include/callback.h"
+#include "../include/cpu.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CONVERT_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define CONVERT_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define TO_FLOAT_SCALE (1.0f / 32768.0f)    // exact, so x * scale == x / 32768
+#define TO_SAMPLE_SCALE 32767.0f
+#define S24_SCALE 8388608.0f                // 2^23
+#define S32_SCALE 2147483648.0              // 2^31
+
+
+// ---------------------------------------------------------------------------
+// Scalar
+// ---------------------------------------------------------------------------
+
+void deinterleaveToFloatScalar(const SAMPLE* in, float* const* out, unsigned long frames, int channels){
+    for (int ch = 0; ch < channels; ch++){
+        const SAMPLE* src = in + ch;
+        float* dst = out[ch];
+        for (unsigned long i = 0; i < frames; i++)
+            dst[i] = toFloat(src[i * channels]);
+    }
+}
+
+void interleaveToSampleScalar(const float* const* in, SAMPLE* out, unsigned long frames, int channels){
+    for (int ch = 0; ch < channels; ch++){
+        const float* src = in[ch];
+        SAMPLE* dst = out + ch;
+        for (unsigned long i = 0; i < frames; i++)
+            dst[i * channels] = toSample(src[i]);
+    }
+}
+
+
+#if CONVERT_X86
+
+// ---------------------------------------------------------------------------
+// SSE2 (baseline on x86-64)
+// ---------------------------------------------------------------------------
+
+__attribute__((target("sse2")))
+static inline __m128i sse2FloatToInt(__m128 v){
+    v = _mm_max_ps(v, _mm_set1_ps(-1.0f));
+    v = _mm_min_ps(v, _mm_set1_ps(1.0f));
+    return _mm_cvttps_epi32(_mm_mul_ps(v, _mm_set1_ps(TO_SAMPLE_SCALE)));
+}
+
+__attribute__((target("sse2")))
+static void deinterleaveToFloatSSE2(const SAMPLE* in, float* const* out, unsigned long frames, int channels){
+    const __m128 scale = _mm_set1_ps(TO_FLOAT_SCALE);
+    unsigned long i = 0;
+
+    if (channels == 1){
+        float* dst = out[0];
+        for (; i + 8 <= frames; i += 8){
+            __m128i v  = _mm_loadu_si128((const __m128i*)(in + i));
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+            _mm_storeu_ps(dst + i,     _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+    }
+    else if (channels == 2){
+        float* left = out[0];
+        float* right = out[1];
+        for (; i + 4 <= frames; i += 4){
+            // L0 R0 L1 R1 L2 R2 L3 R3 -> sign extended pairs
+            __m128i v  = _mm_loadu_si128((const __m128i*)(in + 2 * i));
+            __m128  lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+            __m128  hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+            __m128  l  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128  r  = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(left + i,  _mm_mul_ps(l, scale));
+            _mm_storeu_ps(right + i, _mm_mul_ps(r, scale));
+        }
+    }
+    else{
+        deinterleaveToFloatScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[ch][i] = toFloat(in[i * channels + ch]);
+}
+
+__attribute__((target("sse2")))
+static void interleaveToSampleSSE2(const float* const* in, SAMPLE* out, unsigned long frames, int channels){
+    unsigned long i = 0;
+
+    if (channels == 1){
+        const float* src = in[0];
+        for (; i + 8 <= frames; i += 8){
+            __m128i lo = sse2FloatToInt(_mm_loadu_ps(src + i));
+            __m128i hi = sse2FloatToInt(_mm_loadu_ps(src + i + 4));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+        }
+    }
+    else if (channels == 2){
+        const float* left = in[0];
+        const float* right = in[1];
+        for (; i + 4 <= frames; i += 4){
+            __m128i l = sse2FloatToInt(_mm_loadu_ps(left + i));
+            __m128i r = sse2FloatToInt(_mm_loadu_ps(right + i));
+            __m128i lo = _mm_unpacklo_epi32(l, r);      // L0 R0 L1 R1
+            __m128i hi = _mm_unpackhi_epi32(l, r);      // L2 R2 L3 R3
+            _mm_storeu_si128((__m128i*)(out + 2 * i), _mm_packs_epi32(lo, hi));
+        }
+    }
+    else{
+        interleaveToSampleScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[i * channels + ch] = toSample(in[ch][i]);
+}
+
+
+// ---------------------------------------------------------------------------
+// AVX2
+// ---------------------------------------------------------------------------
+
+__attribute__((target("avx2")))
+static inline __m256i avx2FloatToInt(__m256 v){
+    v = _mm256_max_ps(v, _mm256_set1_ps(-1.0f));
+    v = _mm256_min_ps(v, _mm256_set1_ps(1.0f));
+    return _mm256_cvttps_epi32(_mm256_mul_ps(v, _mm256_set1_ps(TO_SAMPLE_SCALE)));
+}
+
+__attribute__((target("avx2")))
+static void deinterleaveToFloatAVX2(const SAMPLE* in, float* const* out, unsigned long frames, int channels){
+    const __m256 scale = _mm256_set1_ps(TO_FLOAT_SCALE);
+    unsigned long i = 0;
+
+    if (channels == 1){
+        float* dst = out[0];
+        for (; i + 16 <= frames; i += 16){
+            __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+            __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+            __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+            _mm256_storeu_ps(dst + i,     _mm256_mul_ps(lo, scale));
+            _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(hi, scale));
+        }
+    }
+    else if (channels == 2){
+        float* left = out[0];
+        float* right = out[1];
+        for (; i + 8 <= frames; i += 8){
+            __m256i v = _mm256_loadu_si256((const __m256i*)(in + 2 * i));
+            __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));       // frames 0-3
+            __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));  // frames 4-7
+
+            // Shuffles work per 128-bit lane: gives L0 L1 L4 L5 | L2 L3 L6 L7, then fix the order
+            __m256 l = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 r = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+            l = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), _MM_SHUFFLE(3, 1, 2, 0)));
+            r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+
+            _mm256_storeu_ps(left + i,  _mm256_mul_ps(l, scale));
+            _mm256_storeu_ps(right + i, _mm256_mul_ps(r, scale));
+        }
+    }
+    else{
+        deinterleaveToFloatScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[ch][i] = toFloat(in[i * channels + ch]);
+}
+
+__attribute__((target("avx2")))
+static void interleaveToSampleAVX2(const float* const* in, SAMPLE* out, unsigned long frames, int channels){
+    unsigned long i = 0;
+
+    if (channels == 1){
+        const float* src = in[0];
+        for (; i + 16 <= frames; i += 16){
+            __m256i lo = avx2FloatToInt(_mm256_loadu_ps(src + i));
+            __m256i hi = avx2FloatToInt(_mm256_loadu_ps(src + i + 8));
+            // packs works per lane: 0-3 8-11 | 4-7 12-15, then fix the order
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm256_storeu_si256((__m256i*)(out + i), packed);
+        }
+    }
+    else if (channels == 2){
+        const float* left = in[0];
+        const float* right = in[1];
+        for (; i + 8 <= frames; i += 8){
+            __m256i l = avx2FloatToInt(_mm256_loadu_ps(left + i));
+            __m256i r = avx2FloatToInt(_mm256_loadu_ps(right + i));
+            __m256i lo = _mm256_unpacklo_epi32(l, r);   // L0 R0 L1 R1 | L4 R4 L5 R5
+            __m256i hi = _mm256_unpackhi_epi32(l, r);   // L2 R2 L3 R3 | L6 R6 L7 R7
+            _mm256_storeu_si256((__m256i*)(out + 2 * i), _mm256_packs_epi32(lo, hi));
+        }
+    }
+    else{
+        interleaveToSampleScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[i * channels + ch] = toSample(in[ch][i]);
+}
+
+#endif  // CONVERT_X86
+
+
+#if CONVERT_NEON
+
+// ---------------------------------------------------------------------------
+// NEON (always present on our aarch64 boards)
+// ---------------------------------------------------------------------------
+
+static inline int16x4_t neonFloatToSample(float32x4_t v){
+    v = vmaxq_f32(v, vdupq_n_f32(-1.0f));
+    v = vminq_f32(v, vdupq_n_f32(1.0f));
+    return vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(v, TO_SAMPLE_SCALE)));    // vcvtq truncates
+}
+
+static void deinterleaveToFloatNEON(const SAMPLE* in, float* const* out, unsigned long frames, int channels){
+    unsigned long i = 0;
+
+    if (channels == 1){
+        float* dst = out[0];
+        for (; i + 8 <= frames; i += 8){
+            int16x8_t v = vld1q_s16(in + i);
+            vst1q_f32(dst + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), TO_FLOAT_SCALE));
+            vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), TO_FLOAT_SCALE));
+        }
+    }
+    else if (channels == 2){
+        float* left = out[0];
+        float* right = out[1];
+        for (; i + 8 <= frames; i += 8){
+            int16x8x2_t v = vld2q_s16(in + 2 * i);     // deinterleaves L and R
+            vst1q_f32(left + i,      vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[0]))), TO_FLOAT_SCALE));
+            vst1q_f32(left + i + 4,  vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[0]))), TO_FLOAT_SCALE));
+            vst1q_f32(right + i,     vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v.val[1]))), TO_FLOAT_SCALE));
+            vst1q_f32(right + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v.val[1]))), TO_FLOAT_SCALE));
+        }
+    }
+    else{
+        deinterleaveToFloatScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[ch][i] = toFloat(in[i * channels + ch]);
+}
+
+static void interleaveToSampleNEON(const float* const* in, SAMPLE* out, unsigned long frames, int channels){
+    unsigned long i = 0;
+
+    if (channels == 1){
+        const float* src = in[0];
+        for (; i + 8 <= frames; i += 8)
+            vst1q_s16(out + i, vcombine_s16(neonFloatToSample(vld1q_f32(src + i)),
+                                            neonFloatToSample(vld1q_f32(src + i + 4))));
+    }
+    else if (channels == 2){
+        const float* left = in[0];
+        const float* right = in[1];
+        for (; i + 8 <= frames; i += 8){
+            int16x8x2_t v;
+            v.val[0] = vcombine_s16(neonFloatToSample(vld1q_f32(left + i)),
+                                    neonFloatToSample(vld1q_f32(left + i + 4)));
+            v.val[1] = vcombine_s16(neonFloatToSample(vld1q_f32(right + i)),
+                                    neonFloatToSample(vld1q_f32(right + i + 4)));
+            vst2q_s16(out + 2 * i, v);     // interleaves L and R
+        }
+    }
+    else{
+        interleaveToSampleScalar(in, out, frames, channels);
+        return;
+    }
+
+    // Tail
+    for (; i < frames; i++)
+        for (int ch = 0; ch < channels; ch++)
+            out[i * channels + ch] = toSample(in[ch][i]);
+}
+
+#endif  // CONVERT_NEON
+
+
+// ---------------------------------------------------------------------------
+// Runtime dispatch
+// ---------------------------------------------------------------------------
+
+// Every kernel set in this build, best first (AVX2 needs its integer
+// shuffles, SSE2 its 16-bit packs)
+static const CpuChoice<ConvertKernels> KERNEL_TABLE[] = {
+#if CONVERT_X86
+    {CPU_AVX2, {"avx2", deinterleaveToFloatAVX2, interleaveToSampleAVX2}},
+    {CPU_SSE2, {"sse2", deinterleaveToFloatSSE2, interleaveToSampleSSE2}},
+#elif CONVERT_NEON
+    {CPU_NEON, {"neon", deinterleaveToFloatNEON, interleaveToSampleNEON}},
+#endif
+    {CPU_ANY, {"scalar", deinterleaveToFloatScalar, interleaveToSampleScalar}},
+};
+static const int NUM_KERNEL_SETS = sizeof(KERNEL_TABLE) / sizeof(KERNEL_TABLE[0]);
+
+struct KernelList{
+    ConvertKernels kernels[NUM_KERNEL_SETS];
+    int count;
+};
+
+// The kernel sets this CPU runs, best first (scalar always makes the list)
+static KernelList listKernels(){
+    KernelList list;
+    list.count = 0;
+    for (int i = 0; i < NUM_KERNEL_SETS; i++)
+        if (cpuSupports(KERNEL_TABLE[i].needs)) list.kernels[list.count++] = KERNEL_TABLE[i].kernel;
+    return list;
+}
+
+// The conversions use the best of what the CPU runs; the rest are there
+// for test_convert
+static const KernelList SUPPORTED = listKernels();
+static const ConvertKernels KERNELS = SUPPORTED.kernels[0];
+
+
+void deinterleaveToFloat(const SAMPLE* in, float* const* out, unsigned long frames, int channels){
+    KERNELS.toFloat(in, out, frames, channels);
+}
+
+void interleaveToSample(const float* const* in, SAMPLE* out, unsigned long frames, int channels){
+    KERNELS.toSample(in, out, frames, channels);
+}
+
+const char* convertKernelName(){
+    return KERNELS.name;
+}
+
+int convertKernelCount(){
+    return SUPPORTED.count;
+}
+
+const ConvertKernels &convertKernel(int index){
+    return SUPPORTED.kernels[index];
+}
+
+
+// ---------------------------------------------------------------------------
+// Other sample formats
+// ---------------------------------------------------------------------------
+
+static inline float clampUnit(float val){
+    if (val > 1.0f) val = 1.0f;
+    if (val < -1.0f) val = -1.0f;
+    return val;
+}
+
+void deinterleaveFrames(const void* in, SampleFormat format, float* const* out,
+                        unsigned long frames, int channels){
+    if (format == FORMAT_S16){
+        deinterleaveToFloat((const SAMPLE*)in, out, frames, channels);
+        return;
+    }
+
+    for (int ch = 0; ch < channels; ch++){
+        float* dst = out[ch];
+        if (format == FORMAT_FLOAT){
+            const float* src = (const float*)in + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i] = src[i * channels];
+        }
+        else if (format == FORMAT_S24){
+            // sign extend from bit 23, the top byte is not guaranteed to be
+            const int32_t* src = (const int32_t*)in + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i] = (float)((int32_t)((uint32_t)src[i * channels] << 8) >> 8) * (1.0f / S24_SCALE);
+        }
+        else{
+            const int32_t* src = (const int32_t*)in + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i] = (float)(src[i * channels] * (1.0 / S32_SCALE));
+        }
+    }
+}
+
+void interleaveFrames(const float* const* in, void* out, SampleFormat format,
+                      unsigned long frames, int channels){
+    if (format == FORMAT_S16){
+        interleaveToSample(in, (SAMPLE*)out, frames, channels);
+        return;
+    }
+
+    for (int ch = 0; ch < channels; ch++){
+        const float* src = in[ch];
+        if (format == FORMAT_FLOAT){
+            float* dst = (float*)out + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i * channels] = clampUnit(src[i]);
+        }
+        else if (format == FORMAT_S24){
+            int32_t* dst = (int32_t*)out + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i * channels] = (int32_t)(clampUnit(src[i]) * (S24_SCALE - 1.0f));
+        }
+        else{
+            // in double, so full scale does not round past INT32_MAX
+            int32_t* dst = (int32_t*)out + ch;
+            for (unsigned long i = 0; i < frames; i++)
+                dst[i * channels] = (int32_t)(clampUnit(src[i]) * (S32_SCALE - 1.0));
+        }
+    }
+}
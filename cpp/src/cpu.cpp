@@ -0,0 +1,28 @@
+/*
+ * cpu.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the CPU feature checks
+*/
+
+#include "../include/cpu.h"
+
+
+bool cpuSupports(CpuFeature feature){
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    switch (feature){
+        case CPU_SSE:  return __builtin_cpu_supports("sse");
+        case CPU_SSE2: return __builtin_cpu_supports("sse2");
+        case CPU_AVX:  return __builtin_cpu_supports("avx");
+        case CPU_AVX2: return __builtin_cpu_supports("avx2");
+        default: break;
+    }
+#elif defined(__ARM_NEON)
+    if (feature == CPU_NEON) return true;       // part of the build target
+#endif
+    return feature == CPU_ANY;
+}
@@ -0,0 +1,60 @@
+/*
+ * delayline.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the delay line
+*/
+
+#include <algorithm>
+#include "../include/delayline.h"
+
+#define DELAY_INTERP_POINTS 3       // extra samples the widest read touches
+
+
+void delayInit(DelayLine &line, unsigned maxDistance){
+    unsigned capacity = 1;
+    while (capacity < maxDistance + DELAY_INTERP_POINTS) capacity <<= 1;
+
+    line.buffer.assign(capacity, 0.0f);
+    line.mask = capacity - 1;
+    line.index = 0;
+}
+
+
+void delayReset(DelayLine &line){
+    std::fill(line.buffer.begin(), line.buffer.end(), 0.0f);
+    line.index = 0;
+}
+
+
+void delayWriteBlock(DelayLine &line, const float* in, unsigned long frames){
+    // Copy in at most two runs (before and after the wrap)
+    while (frames > 0){
+        unsigned long run = line.mask + 1 - line.index;
+        if (run > frames) run = frames;
+
+        std::copy(in, in + run, line.buffer.data() + line.index);
+        line.index = (line.index + run) & line.mask;
+        in += run;
+        frames -= run;
+    }
+}
+
+
+void delayCopy(const DelayLine &line, unsigned distance, float* out, unsigned long frames){
+    unsigned start = (line.index - distance) & line.mask;
+
+    // At most two runs (before and after the wrap)
+    while (frames > 0){
+        unsigned long run = line.mask + 1 - start;
+        if (run > frames) run = frames;
+
+        std::copy(line.buffer.data() + start, line.buffer.data() + start + run, out);
+        start = (start + run) & line.mask;
+        out += run;
+        frames -= run;
+    }
+}
@@ -0,0 +1,324 @@
+/*
+ * engine.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the multi-instance engine
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../include/engine.h"
+#include "../include/callback.h"
+#include "../include/control.h"
+#include "../include/init.h"
+
+#define RANGE_FRONT(r) ((unsigned)((r) & 0xffff))
+#define RANGE_BACK(r)  ((unsigned)(((r) >> 16) & 0xffff))
+#define RANGE_TAG(r)   ((uint32_t)((r) >> 32))
+
+
+// ---------------------------------------------------------------------------
+// Jobs
+// ---------------------------------------------------------------------------
+
+// Run one instance over the period: gather its channels, process, scatter
+static void runJob(Engine &engine, int job){
+    EngineInstance &instance = *engine.instances[job];
+    const unsigned long frames = engine.frames;
+    const size_t bytes = sampleBytes(engine.format);
+    const size_t deviceFrame = engine.channels * bytes;
+    const size_t frameBytes = instance.params.CHANNELS * bytes;
+    const size_t offset = instance.firstChannel * bytes;
+
+    const unsigned char* src = (const unsigned char*)engine.in + offset;
+    unsigned char* dst = instance.in.data();
+    for (unsigned long i = 0; i < frames; i++, src += deviceFrame, dst += frameBytes)
+        memcpy(dst, src, frameBytes);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    processBlock(instance.in.data(), instance.out.data(), frames, &instance.ud);
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::steady_clock::now() - start).count();
+
+    const unsigned char* back = instance.out.data();
+    unsigned char* out = (unsigned char*)engine.out + offset;
+    for (unsigned long i = 0; i < frames; i++, back += frameBytes, out += deviceFrame)
+        memcpy(out, back, frameBytes);
+
+    // Moving average of the cost, for the next period's schedule
+    int64_t cost = instance.costNs;
+    cost += (elapsed - cost) >> ENGINE_COST_SHIFT;
+    instance.costNs = (uint32_t)(cost < 0 ? 0 : cost);
+
+    engine.remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+
+// Take a job of period tag from the front (owner) or back (thief) of a queue
+static bool takeJob(EngineQueue &queue, uint32_t tag, bool fromBack, int &job){
+    uint64_t range = queue.range.load(std::memory_order_acquire);
+    while (true){
+        unsigned front = RANGE_FRONT(range), back = RANGE_BACK(range);
+        if (RANGE_TAG(range) != tag || front >= back) return false;
+
+        uint64_t next = fromBack ? range - (1ull << 16) : range + 1;
+        if (queue.range.compare_exchange_weak(range, next, std::memory_order_acq_rel,
+                                              std::memory_order_acquire)){
+            job = queue.jobs[fromBack ? back - 1 : front];
+            return true;
+        }
+    }
+}
+
+
+// Work through a period: own queue first, then steal
+static void work(Engine &engine, int self, uint32_t tag){
+    int job;
+    while (takeJob(engine.queues[self], tag, false, job))
+        runJob(engine, job);
+
+    for (int i = 1; i < engine.threads; i++){
+        EngineQueue &victim = engine.queues[(self + i) % engine.threads];
+        while (takeJob(victim, tag, true, job)){
+            engine.stats.steals.fetch_add(1, std::memory_order_relaxed);
+            runJob(engine, job);
+        }
+    }
+}
+
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+// Wait for the period counter to move on from seen; returns the new value
+static uint32_t waitPeriod(Engine &engine, uint32_t seen){
+    for (int i = 0; i < ENGINE_SPIN; i++){
+        uint32_t period = engine.period.load(std::memory_order_acquire);
+        if (period != seen) return period;
+        cpuRelax();
+    }
+
+    // Sleeping is announced before the last check, and the caller checks
+    // for sleepers after publishing (both seq_cst), so no wake is missed
+    engine.sleeping.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t period;
+    while ((period = engine.period.load(std::memory_order_seq_cst)) == seen)
+        futexWait(engine.period, seen);
+    engine.sleeping.fetch_sub(1, std::memory_order_relaxed);
+    return period;
+}
+
+static void* workerMain(void* arg){
+    EngineWorker &worker = *(EngineWorker*)arg;
+    Engine &engine = *worker.engine;
+    prefaultStack();
+    AudioPathScope audioPath;
+
+    uint32_t seen = engine.period.load(std::memory_order_acquire);
+    while (true){
+        seen = waitPeriod(engine, seen);
+        if (!engine.running.load(std::memory_order_acquire)) break;
+        work(engine, worker.index, seen);
+    }
+    return NULL;
+}
+
+
+// ---------------------------------------------------------------------------
+// Control side
+// ---------------------------------------------------------------------------
+
+int engineInit(Engine &engine, const EngineConfig &config, int instances,
+               const AudioParams &params, const EffectChoices &effects,
+               const ImpulseResponse &ir, unsigned long maxFrames){
+    if (instances < 1 || instances > ENGINE_MAX_INSTANCES){
+        fprintf(stderr, "Error: 1-%d instances\n", ENGINE_MAX_INSTANCES);
+        return -1;
+    }
+    if (params.CHANNELS % instances != 0 || params.CHANNELS / instances > AudioParams::MAX_CHANNELS){
+        fprintf(stderr, "Error: %d channels do not split into %d instances of at most %d channels\n",
+                params.CHANNELS, instances, AudioParams::MAX_CHANNELS);
+        return -1;
+    }
+
+    const int perInstance = params.CHANNELS / instances;
+    const size_t blockBytes = maxFrames * perInstance * sampleBytes(params.FORMAT);
+
+    engine.channels = params.CHANNELS;
+    engine.sampleRate = params.SAMPLE_RATE;
+    engine.format = params.FORMAT;
+    engine.maxFrames = maxFrames;
+
+    for (int i = 0; i < instances; i++){
+        EngineInstance* instance = new EngineInstance();
+        instance->params = params;
+        instance->params.CHANNELS = perInstance;
+        instance->effects = effects;
+        instance->firstChannel = i * perInstance;
+        instance->ud.impulse = ir;
+        initData(instance->ud, instance->params, instance->effects);
+        ArenaScope scope(instance->ud.arena);
+        instance->in.assign(blockBytes, 0);
+        instance->out.assign(blockBytes, 0);
+        engine.instances.push_back(instance);
+    }
+
+    // Workers (thread 0 is the caller)
+    engine.threads = config.threads;
+    if (engine.threads < 1) engine.threads = 1;
+    if (engine.threads > ENGINE_MAX_THREADS) engine.threads = ENGINE_MAX_THREADS;
+    engine.running.store(true, std::memory_order_release);
+
+    for (int i = 1; i < engine.threads; i++){
+        EngineWorker &worker = engine.workers[i];
+        worker.engine = &engine;
+        worker.index = i;
+
+        RtThreadConfig threadConfig = config.worker;
+        if (config.pin) threadConfig.cpu = i;
+        if (startRtThread(&worker.thread, threadConfig, workerMain, &worker) < 0){
+            engine.threads = i;     // run with the workers that did start
+            break;
+        }
+        worker.started = true;
+    }
+    return 0;
+}
+
+
+void engineShutdown(Engine &engine){
+    engine.running.store(false, std::memory_order_release);
+    engine.period.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(engine.period);
+
+    for (int i = 1; i < ENGINE_MAX_THREADS; i++){
+        if (!engine.workers[i].started) continue;
+        pthread_join(engine.workers[i].thread, NULL);
+        engine.workers[i].started = false;
+    }
+
+    for (size_t i = 0; i < engine.instances.size(); i++)
+        delete engine.instances[i];
+    engine.instances.clear();
+}
+
+
+void engineSetEffects(Engine &engine, const EffectChoices &effects){
+    for (size_t i = 0; i < engine.instances.size(); i++)
+        engine.instances[i]->effects = effects;
+}
+
+
+void engineReset(Engine &engine){
+    for (size_t i = 0; i < engine.instances.size(); i++){
+        EngineInstance &instance = *engine.instances[i];
+        resetData(instance.ud);
+        initData(instance.ud, instance.params, instance.effects);
+        instance.costNs = 0;
+    }
+}
+
+
+bool engineControlLine(Engine &engine, const std::string &line){
+    // "<n>:" prefix picks one instance
+    size_t colon = line.find(':');
+    size_t start = line.find_first_not_of(" \t");
+    if (colon != std::string::npos && start < colon){
+        std::string prefix = line.substr(start, colon - start);
+        if (prefix.find_first_not_of("0123456789") == std::string::npos){
+            int index = atoi(prefix.c_str());
+            if (index < 1 || index > (int)engine.instances.size()){
+                fprintf(stderr, "No instance %d (1-%d)\n", index, (int)engine.instances.size());
+                return false;
+            }
+            return sendControlLine(engine.instances[index - 1]->ud, line.substr(colon + 1));
+        }
+    }
+
+    bool sent = true;
+    for (size_t i = 0; i < engine.instances.size() && sent; i++)
+        sent = sendControlLine(engine.instances[i]->ud, line);
+    return sent;
+}
+
+
+// ---------------------------------------------------------------------------
+// Audio side
+// ---------------------------------------------------------------------------
+
+// Deal the period's jobs, longest first, to the least loaded queues and
+// publish it to the workers
+static uint32_t schedule(Engine &engine){
+    const int count = (int)engine.instances.size();
+
+    uint8_t order[ENGINE_MAX_INSTANCES];
+    for (int i = 0; i < count; i++){
+        uint8_t job = (uint8_t)i;
+        uint32_t cost = engine.instances[i]->costNs;
+        int j = i;
+        for (; j > 0 && engine.instances[order[j - 1]]->costNs < cost; j--)
+            order[j] = order[j - 1];
+        order[j] = job;
+    }
+
+    uint64_t load[ENGINE_MAX_THREADS] = {};
+    unsigned queued[ENGINE_MAX_THREADS] = {};
+    for (int i = 0; i < count; i++){
+        int least = 0;
+        for (int t = 1; t < engine.threads; t++)
+            if (load[t] < load[least]) least = t;
+        engine.queues[least].jobs[queued[least]++] = order[i];
+        load[least] += engine.instances[order[i]]->costNs + 1;
+    }
+
+    const uint32_t tag = engine.period.load(std::memory_order_relaxed) + 1;
+    engine.remaining.store(count, std::memory_order_relaxed);
+    for (int t = 0; t < engine.threads; t++)
+        engine.queues[t].range.store((uint64_t)tag << 32 | (uint64_t)queued[t] << 16,
+                                     std::memory_order_release);
+
+    engine.period.store(tag, std::memory_order_seq_cst);
+    if (engine.sleeping.load(std::memory_order_seq_cst) > 0)
+        futexWakeAll(engine.period);
+    return tag;
+}
+
+
+void engineProcess(Engine &engine, const void* in, void* out, unsigned long frames){
+    const size_t frameBytes = engine.channels * sampleBytes(engine.format);
+    const unsigned char* inBytes = (const unsigned char*)in;
+    unsigned char* outBytes = (unsigned char*)out;
+
+    while (frames > 0){
+        unsigned long chunk = frames < engine.maxFrames ? frames : engine.maxFrames;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        engine.in = inBytes;
+        engine.out = outBytes;
+        engine.frames = chunk;
+        uint32_t tag = schedule(engine);
+
+        // The caller works too, then waits for the last job
+        work(engine, 0, tag);
+        while (engine.remaining.load(std::memory_order_acquire) > 0)
+            cpuRelax();
+
+        uint64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start).count();
+        uint64_t deadline = (uint64_t)chunk * 1000000000ull / engine.sampleRate;
+        engine.stats.periods.fetch_add(1, std::memory_order_relaxed);
+        engine.stats.lastPeriodNs.store((uint32_t)elapsed, std::memory_order_relaxed);
+        if (elapsed > deadline)
+            engine.stats.deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+
+        inBytes += chunk * frameBytes;
+        outBytes += chunk * frameBytes;
+        frames -= chunk;
+    }
+}
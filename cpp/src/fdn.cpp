@@ -0,0 +1,355 @@
+/*
+ * fdn.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the feedback delay network reverb
+*/
+
+#include <algorithm>
+#include <cmath>
+#include "../include/cpu.h"
+#include "../include/fdn.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FDN_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define FDN_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Line lengths in milliseconds (mutually prime at 44.1 kHz, spread so the
+// echoes do not line up)
+static const float LINE_MS[FDN_LINES] = {
+    29.7f, 37.1f, 41.1f, 43.7f, 53.3f, 59.9f, 67.3f, 73.9f
+};
+
+#define FDN_INPUT_GAIN  0.35f
+#define FDN_OUTPUT_GAIN 0.5f
+
+
+// One run of frames in which no line position wraps
+struct FdnRun{
+    const float* read[FDN_LINES];       // line outputs (FDN_LINES floats per frame)
+    float*       write;                 // line inputs (FDN_LINES floats per frame)
+    float*       x[FDN_LINES];          // channel buffers at the first frame
+    int          channels;
+    float        gain[FDN_LINES];
+    float        lowpass[FDN_LINES];    // updated by the kernel
+    float        damping;
+    float        dry;
+    float        inWeight[FDN_LINES][FDN_LINES];     // [channel][line]
+    float        outWeight[FDN_LINES][FDN_LINES];    // [channel][line]
+};
+
+// Kernels sum across the lines in the same order (pairs 4 apart, then 2,
+// then 1) and never fuse multiply-adds, so they all give the same output.
+typedef void (*FdnKernel)(FdnRun &run, unsigned long frames);
+
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+
+static inline float sumLines(const float* v){
+    float s0 = v[0] + v[4], s1 = v[1] + v[5], s2 = v[2] + v[6], s3 = v[3] + v[7];
+    return (s0 + s2) + (s1 + s3);
+}
+
+static void fdnKernelScalar(FdnRun &run, unsigned long frames){
+    const float householder = 2.0f / FDN_LINES;
+    float* lowpass = run.lowpass;
+
+    for (unsigned long n = 0; n < frames; n++){
+        float out[FDN_LINES], feedback[FDN_LINES], weighted[FDN_LINES];
+
+        // Read the line outputs and damp them
+        for (int k = 0; k < FDN_LINES; k++){
+            out[k] = run.read[k][n * FDN_LINES];
+            lowpass[k] = out[k] + run.damping * (lowpass[k] - out[k]);
+            feedback[k] = run.gain[k] * lowpass[k];
+        }
+        float sum = sumLines(feedback) * householder;
+
+        // Householder feedback plus the new input
+        float* write = run.write + n * FDN_LINES;
+        for (int k = 0; k < FDN_LINES; k++)
+            write[k] = feedback[k] - sum;
+        for (int ch = 0; ch < run.channels; ch++){
+            const float x = run.x[ch][n];
+            for (int k = 0; k < FDN_LINES; k++)
+                write[k] = write[k] + run.inWeight[ch][k] * x;
+        }
+
+        // Each channel hears its own lines
+        for (int ch = 0; ch < run.channels; ch++){
+            for (int k = 0; k < FDN_LINES; k++)
+                weighted[k] = run.outWeight[ch][k] * out[k];
+            run.x[ch][n] = run.dry * run.x[ch][n] + sumLines(weighted);
+        }
+    }
+}
+
+#if FDN_X86
+
+// Sum of 4 lanes, in every lane (pairs 2 apart, then 1)
+__attribute__((target("sse")))
+static inline __m128 sumLanesSSE(__m128 v){
+    v = _mm_add_ps(v, _mm_shuffle_ps(v, v, 0x4E));
+    return _mm_add_ps(v, _mm_shuffle_ps(v, v, 0xB1));
+}
+
+__attribute__((target("sse")))
+static void fdnKernelSSE(FdnRun &run, unsigned long frames){
+    const __m128 householder = _mm_set1_ps(2.0f / FDN_LINES);
+    const __m128 damping = _mm_set1_ps(run.damping);
+    const __m128 gainLo = _mm_loadu_ps(run.gain), gainHi = _mm_loadu_ps(run.gain + 4);
+    __m128 lowpassLo = _mm_loadu_ps(run.lowpass), lowpassHi = _mm_loadu_ps(run.lowpass + 4);
+
+    for (unsigned long n = 0; n < frames; n++){
+        const unsigned long i = n * FDN_LINES;
+        __m128 outLo = _mm_set_ps(run.read[3][i], run.read[2][i], run.read[1][i], run.read[0][i]);
+        __m128 outHi = _mm_set_ps(run.read[7][i], run.read[6][i], run.read[5][i], run.read[4][i]);
+
+        lowpassLo = _mm_add_ps(outLo, _mm_mul_ps(damping, _mm_sub_ps(lowpassLo, outLo)));
+        lowpassHi = _mm_add_ps(outHi, _mm_mul_ps(damping, _mm_sub_ps(lowpassHi, outHi)));
+        __m128 feedbackLo = _mm_mul_ps(gainLo, lowpassLo);
+        __m128 feedbackHi = _mm_mul_ps(gainHi, lowpassHi);
+        __m128 sum = _mm_mul_ps(sumLanesSSE(_mm_add_ps(feedbackLo, feedbackHi)), householder);
+
+        __m128 inLo = _mm_sub_ps(feedbackLo, sum);
+        __m128 inHi = _mm_sub_ps(feedbackHi, sum);
+        for (int ch = 0; ch < run.channels; ch++){
+            const __m128 x = _mm_set1_ps(run.x[ch][n]);
+            inLo = _mm_add_ps(inLo, _mm_mul_ps(_mm_loadu_ps(run.inWeight[ch]), x));
+            inHi = _mm_add_ps(inHi, _mm_mul_ps(_mm_loadu_ps(run.inWeight[ch] + 4), x));
+        }
+        _mm_storeu_ps(run.write + i, inLo);
+        _mm_storeu_ps(run.write + i + 4, inHi);
+
+        for (int ch = 0; ch < run.channels; ch++){
+            __m128 wet = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(run.outWeight[ch]), outLo),
+                                    _mm_mul_ps(_mm_loadu_ps(run.outWeight[ch] + 4), outHi));
+            run.x[ch][n] = run.dry * run.x[ch][n] + _mm_cvtss_f32(sumLanesSSE(wet));
+        }
+    }
+
+    _mm_storeu_ps(run.lowpass, lowpassLo);
+    _mm_storeu_ps(run.lowpass + 4, lowpassHi);
+}
+
+// Sum of 8 lanes, in every lane (pairs 4 apart, then 2, then 1)
+__attribute__((target("avx")))
+static inline __m256 sumLanesAVX(__m256 v){
+    v = _mm256_add_ps(v, _mm256_permute2f128_ps(v, v, 0x01));
+    v = _mm256_add_ps(v, _mm256_shuffle_ps(v, v, 0x4E));
+    return _mm256_add_ps(v, _mm256_shuffle_ps(v, v, 0xB1));
+}
+
+__attribute__((target("avx")))
+static void fdnKernelAVX(FdnRun &run, unsigned long frames){
+    const __m256 householder = _mm256_set1_ps(2.0f / FDN_LINES);
+    const __m256 damping = _mm256_set1_ps(run.damping);
+    const __m256 gain = _mm256_loadu_ps(run.gain);
+    __m256 lowpass = _mm256_loadu_ps(run.lowpass);
+
+    for (unsigned long n = 0; n < frames; n++){
+        const unsigned long i = n * FDN_LINES;
+        __m256 out = _mm256_set_ps(run.read[7][i], run.read[6][i], run.read[5][i], run.read[4][i],
+                                   run.read[3][i], run.read[2][i], run.read[1][i], run.read[0][i]);
+
+        lowpass = _mm256_add_ps(out, _mm256_mul_ps(damping, _mm256_sub_ps(lowpass, out)));
+        __m256 feedback = _mm256_mul_ps(gain, lowpass);
+        __m256 sum = _mm256_mul_ps(sumLanesAVX(feedback), householder);
+
+        __m256 in = _mm256_sub_ps(feedback, sum);
+        for (int ch = 0; ch < run.channels; ch++)
+            in = _mm256_add_ps(in, _mm256_mul_ps(_mm256_loadu_ps(run.inWeight[ch]), _mm256_set1_ps(run.x[ch][n])));
+        _mm256_storeu_ps(run.write + i, in);
+
+        for (int ch = 0; ch < run.channels; ch++){
+            __m256 wet = sumLanesAVX(_mm256_mul_ps(_mm256_loadu_ps(run.outWeight[ch]), out));
+            run.x[ch][n] = run.dry * run.x[ch][n] + _mm256_cvtss_f32(wet);
+        }
+    }
+
+    _mm256_storeu_ps(run.lowpass, lowpass);
+}
+
+#endif  // FDN_X86
+
+#if FDN_NEON
+
+// Sum of 4 lanes, in every lane (pairs 2 apart, then 1)
+static inline float32x4_t sumLanesNEON(float32x4_t v){
+    v = vaddq_f32(v, vextq_f32(v, v, 2));
+    return vaddq_f32(v, vrev64q_f32(v));
+}
+
+static void fdnKernelNEON(FdnRun &run, unsigned long frames){
+    const float32x4_t householder = vdupq_n_f32(2.0f / FDN_LINES);
+    const float32x4_t damping = vdupq_n_f32(run.damping);
+    const float32x4_t gainLo = vld1q_f32(run.gain), gainHi = vld1q_f32(run.gain + 4);
+    float32x4_t lowpassLo = vld1q_f32(run.lowpass), lowpassHi = vld1q_f32(run.lowpass + 4);
+
+    for (unsigned long n = 0; n < frames; n++){
+        const unsigned long i = n * FDN_LINES;
+        float outLines[FDN_LINES];
+        for (int k = 0; k < FDN_LINES; k++)
+            outLines[k] = run.read[k][i];
+        float32x4_t outLo = vld1q_f32(outLines), outHi = vld1q_f32(outLines + 4);
+
+        // no fused multiply-add
+        lowpassLo = vaddq_f32(outLo, vmulq_f32(damping, vsubq_f32(lowpassLo, outLo)));
+        lowpassHi = vaddq_f32(outHi, vmulq_f32(damping, vsubq_f32(lowpassHi, outHi)));
+        float32x4_t feedbackLo = vmulq_f32(gainLo, lowpassLo);
+        float32x4_t feedbackHi = vmulq_f32(gainHi, lowpassHi);
+        float32x4_t sum = vmulq_f32(sumLanesNEON(vaddq_f32(feedbackLo, feedbackHi)), householder);
+
+        float32x4_t inLo = vsubq_f32(feedbackLo, sum);
+        float32x4_t inHi = vsubq_f32(feedbackHi, sum);
+        for (int ch = 0; ch < run.channels; ch++){
+            const float x = run.x[ch][n];
+            inLo = vaddq_f32(inLo, vmulq_n_f32(vld1q_f32(run.inWeight[ch]), x));
+            inHi = vaddq_f32(inHi, vmulq_n_f32(vld1q_f32(run.inWeight[ch] + 4), x));
+        }
+        vst1q_f32(run.write + i, inLo);
+        vst1q_f32(run.write + i + 4, inHi);
+
+        for (int ch = 0; ch < run.channels; ch++){
+            float32x4_t wet = vaddq_f32(vmulq_f32(vld1q_f32(run.outWeight[ch]), outLo),
+                                        vmulq_f32(vld1q_f32(run.outWeight[ch] + 4), outHi));
+            run.x[ch][n] = run.dry * run.x[ch][n] + vgetq_lane_f32(sumLanesNEON(wet), 0);
+        }
+    }
+
+    vst1q_f32(run.lowpass, lowpassLo);
+    vst1q_f32(run.lowpass + 4, lowpassHi);
+}
+
+#endif  // FDN_NEON
+
+
+struct FdnDispatch{
+    const char* name;
+    FdnKernel   kernel;
+};
+
+// Kernels for the eight lines: one AVX register, two SSE / NEON registers
+static const CpuChoice<FdnDispatch> FDN_KERNELS[] = {
+#if FDN_X86
+    {CPU_AVX, {"avx", fdnKernelAVX}},
+    {CPU_SSE, {"sse", fdnKernelSSE}},
+#elif FDN_NEON
+    {CPU_NEON, {"neon", fdnKernelNEON}},
+#endif
+    {CPU_ANY, {"scalar", fdnKernelScalar}},
+};
+
+// The reverb runs this one for every block
+static const FdnDispatch KERNEL = cpuSelect(FDN_KERNELS, sizeof(FDN_KERNELS) / sizeof(FDN_KERNELS[0]));
+
+
+// ---------------------------------------------------------------------------
+// Reverb
+// ---------------------------------------------------------------------------
+
+void fdnInit(FdnReverb &fdn, float sampleRate){
+    int longest = 1;
+    for (int k = 0; k < FDN_LINES; k++){
+        fdn.delay[k] = std::max(1, (int)(LINE_MS[k] * sampleRate / 1000.0f)) | 1;
+        longest = std::max(longest, fdn.delay[k]);
+    }
+
+    int size = 1;
+    while (size <= longest) size <<= 1;
+
+    fdn.mask = size - 1;
+    fdn.buffer.assign((size_t)size * FDN_LINES, 0.0f);
+    fdnReset(fdn);
+}
+
+
+void fdnSetDecay(FdnReverb &fdn, float reverbTime, float damping, float sampleRate){
+    if (reverbTime < 0.01f) reverbTime = 0.01f;
+    if (damping < 0.0f) damping = 0.0f;
+    if (damping > 0.99f) damping = 0.99f;
+
+    // -60 dB after reverbTime seconds: g^(rate * T / d) = 10^-3
+    for (int k = 0; k < FDN_LINES; k++)
+        fdn.gain[k] = powf(10.0f, -3.0f * fdn.delay[k] / (reverbTime * sampleRate));
+    fdn.damping = damping;
+}
+
+
+void fdnReset(FdnReverb &fdn){
+    std::fill(fdn.buffer.begin(), fdn.buffer.end(), 0.0f);
+    std::fill(fdn.lowpass, fdn.lowpass + FDN_LINES, 0.0f);
+    fdn.index = 0;
+}
+
+
+void fdnProcess(FdnReverb &fdn, float* const* block, int channels,
+                unsigned long frames, float mix){
+    float* buffer = fdn.buffer.data();
+    const int mask = fdn.mask;
+    const unsigned long size = mask + 1;
+
+    FdnRun run;
+    run.channels = channels;
+    run.damping = fdn.damping;
+    run.dry = 1.0f - mix;
+
+    int readIndex[FDN_LINES];
+    for (int k = 0; k < FDN_LINES; k++){
+        run.gain[k] = fdn.gain[k];
+        run.lowpass[k] = fdn.lowpass[k];
+        readIndex[k] = (fdn.index - fdn.delay[k]) & mask;
+    }
+
+    // Line k is fed from and heard on channel k % channels. As weights, so
+    // the per-frame routing is plain vector math instead of indexing.
+    const float outputGain = mix * FDN_OUTPUT_GAIN * sqrtf((float)channels / FDN_LINES);
+    for (int ch = 0; ch < FDN_LINES; ch++)
+        for (int k = 0; k < FDN_LINES; k++){
+            run.inWeight[ch][k] = k % channels == ch ? FDN_INPUT_GAIN : 0.0f;
+            run.outWeight[ch][k] = k % channels == ch ? outputGain : 0.0f;
+        }
+
+    int writeIndex = fdn.index;
+    unsigned long i = 0;
+
+    while (i < frames){
+        // Run until the write position or any read position wraps, so the
+        // kernel needs no masking
+        unsigned long length = frames - i;
+        if (length > size - writeIndex) length = size - writeIndex;
+        for (int k = 0; k < FDN_LINES; k++)
+            if (length > size - readIndex[k]) length = size - readIndex[k];
+
+        for (int k = 0; k < FDN_LINES; k++)
+            run.read[k] = buffer + readIndex[k] * FDN_LINES + k;
+        run.write = buffer + writeIndex * FDN_LINES;
+        for (int ch = 0; ch < channels; ch++)
+            run.x[ch] = block[ch] + i;
+
+        KERNEL.kernel(run, length);
+
+        for (int k = 0; k < FDN_LINES; k++)
+            readIndex[k] = (readIndex[k] + length) & mask;
+        writeIndex = (writeIndex + length) & mask;
+        i += length;
+    }
+
+    for (int k = 0; k < FDN_LINES; k++)
+        fdn.lowpass[k] = run.lowpass[k];
+    fdn.index = writeIndex;
+}
+
+
+const char* fdnKernelName(){
+    return KERNEL.name;
+}
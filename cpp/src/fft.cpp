@@ -0,0 +1,151 @@
+/*
+ * fft.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the real FFT
+*/
+
+#include <cmath>
+#include "../include/fft.h"
+
+#define FFT_PI 3.14159265358979323846
+
+
+void fftInit(FftPlan &plan, int size){
+    const int half = size / 2;
+    plan.size = size;
+
+    int bits = 0;
+    while ((1 << bits) < half) bits++;
+
+    plan.bitReverse.resize(half);
+    for (int i = 0; i < half; i++){
+        int reversed = 0;
+        for (int b = 0; b < bits; b++)
+            if (i & (1 << b)) reversed |= 1 << (bits - 1 - b);
+        plan.bitReverse[i] = reversed;
+    }
+
+    plan.twiddleCos.resize(half / 2);
+    plan.twiddleSin.resize(half / 2);
+    for (int i = 0; i < half / 2; i++){
+        plan.twiddleCos[i] = (float)cos(2.0 * FFT_PI * i / half);
+        plan.twiddleSin[i] = (float)-sin(2.0 * FFT_PI * i / half);
+    }
+
+    plan.splitCos.resize(half);
+    plan.splitSin.resize(half);
+    for (int k = 0; k < half; k++){
+        plan.splitCos[k] = (float)cos(2.0 * FFT_PI * k / size);
+        plan.splitSin[k] = (float)-sin(2.0 * FFT_PI * k / size);
+    }
+
+    plan.workRe.assign(half, 0.0f);
+    plan.workIm.assign(half, 0.0f);
+}
+
+
+// In place complex FFT of plan.size / 2 points (input already bit reversed).
+// inverse uses conjugate twiddles and does not scale.
+static void complexFft(const FftPlan &plan, float* re, float* im, bool inverse){
+    const int n = plan.size / 2;
+    const float sign = inverse ? -1.0f : 1.0f;
+
+    for (int length = 2; length <= n; length <<= 1){
+        const int halfLength = length / 2;
+        const int step = n / length;
+
+        for (int start = 0; start < n; start += length){
+            float* aRe = re + start;
+            float* aIm = im + start;
+            float* bRe = aRe + halfLength;
+            float* bIm = aIm + halfLength;
+
+            for (int j = 0; j < halfLength; j++){
+                const float wRe = plan.twiddleCos[j * step];
+                const float wIm = sign * plan.twiddleSin[j * step];
+                const float tRe = wRe * bRe[j] - wIm * bIm[j];
+                const float tIm = wRe * bIm[j] + wIm * bRe[j];
+                bRe[j] = aRe[j] - tRe;
+                bIm[j] = aIm[j] - tIm;
+                aRe[j] += tRe;
+                aIm[j] += tIm;
+            }
+        }
+    }
+}
+
+
+void fftRealForward(FftPlan &plan, const float* in, float* re, float* im){
+    const int half = plan.size / 2;
+    float* zRe = plan.workRe.data();
+    float* zIm = plan.workIm.data();
+
+    // Pack even samples as real, odd samples as imaginary
+    for (int i = 0; i < half; i++){
+        const int j = plan.bitReverse[i];
+        zRe[j] = in[2 * i];
+        zIm[j] = in[2 * i + 1];
+    }
+    complexFft(plan, zRe, zIm, false);
+
+    // Split: X[k] = E[k] + W^k O[k]
+    //   E[k] = (Z[k] + conj(Z[half - k])) / 2
+    //   O[k] = -i (Z[k] - conj(Z[half - k])) / 2
+    re[0] = zRe[0] + zIm[0];
+    im[0] = 0.0f;
+    re[half] = zRe[0] - zIm[0];
+    im[half] = 0.0f;
+
+    for (int k = 1; k < half; k++){
+        const float aRe = zRe[k], aIm = zIm[k];
+        const float bRe = zRe[half - k], bIm = -zIm[half - k];
+
+        const float eRe = 0.5f * (aRe + bRe);
+        const float eIm = 0.5f * (aIm + bIm);
+        const float oRe = 0.5f * (aIm - bIm);
+        const float oIm = -0.5f * (aRe - bRe);
+
+        const float wRe = plan.splitCos[k], wIm = plan.splitSin[k];
+        re[k] = eRe + wRe * oRe - wIm * oIm;
+        im[k] = eIm + wRe * oIm + wIm * oRe;
+    }
+}
+
+
+void fftRealInverse(FftPlan &plan, const float* re, const float* im, float* out){
+    const int half = plan.size / 2;
+    float* zRe = plan.workRe.data();
+    float* zIm = plan.workIm.data();
+
+    // Unsplit: Z[k] = E[k] + i O[k]
+    //   E[k] = (X[k] + conj(X[half - k])) / 2
+    //   O[k] = (X[k] - conj(X[half - k])) / 2 * W^-k
+    for (int k = 0; k < half; k++){
+        const float aRe = re[k], aIm = im[k];
+        const float bRe = re[half - k], bIm = -im[half - k];
+
+        const float eRe = 0.5f * (aRe + bRe);
+        const float eIm = 0.5f * (aIm + bIm);
+        const float dRe = 0.5f * (aRe - bRe);
+        const float dIm = 0.5f * (aIm - bIm);
+
+        const float wRe = plan.splitCos[k], wIm = -plan.splitSin[k];
+        const float oRe = dRe * wRe - dIm * wIm;
+        const float oIm = dRe * wIm + dIm * wRe;
+
+        const int j = plan.bitReverse[k];
+        zRe[j] = eRe - oIm;
+        zIm[j] = eIm + oRe;
+    }
+    complexFft(plan, zRe, zIm, true);
+
+    const float scale = 1.0f / half;
+    for (int i = 0; i < half; i++){
+        out[2 * i] = zRe[i] * scale;
+        out[2 * i + 1] = zIm[i] * scale;
+    }
+}
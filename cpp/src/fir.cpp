@@ -0,0 +1,191 @@
+/*
+ * fir.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the block FIR filter engine
+ *
+ * NOTE: Every kernel sums the taps in the same order with separate
+ * multiplies and adds, so all of them give the same result as the scalar
+ * one (and as the old per-sample tone filter).
+*/
+
+#include <cmath>
+#include <cstring>
+#include "../include/cpu.h"
+#include "../include/fir.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FIR_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define FIR_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define FIR_PI 3.14159265358979323846
+
+// Kernel: out[i] = sum_j coeffs[j] * x[i + taps - 1 - j], x being the history line
+typedef void (*FirKernel)(const float* coeffs, int taps, const float* x, float* out, int frames);
+
+
+// ---------------------------------------------------------------------------
+// Kernels
+// ---------------------------------------------------------------------------
+
+static void firKernelScalar(const float* coeffs, int taps, const float* x, float* out, int frames){
+    const float* newest = x + taps - 1;
+    for (int i = 0; i < frames; i++){
+        float acc = 0.0f;
+        for (int j = 0; j < taps; j++)
+            acc += coeffs[j] * newest[i - j];
+        out[i] = acc;
+    }
+}
+
+#if FIR_X86
+
+__attribute__((target("sse")))
+static void firKernelSSE(const float* coeffs, int taps, const float* x, float* out, int frames){
+    const float* newest = x + taps - 1;
+    int i = 0;
+    for (; i + 4 <= frames; i += 4){
+        __m128 acc = _mm_setzero_ps();
+        for (int j = 0; j < taps; j++)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(coeffs[j]), _mm_loadu_ps(newest + i - j)));
+        _mm_storeu_ps(out + i, acc);
+    }
+    firKernelScalar(coeffs, taps, x + i, out + i, frames - i);
+}
+
+__attribute__((target("avx")))
+static void firKernelAVX(const float* coeffs, int taps, const float* x, float* out, int frames){
+    const float* newest = x + taps - 1;
+    int i = 0;
+    for (; i + 16 <= frames; i += 16){
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        for (int j = 0; j < taps; j++){
+            __m256 c = _mm256_set1_ps(coeffs[j]);
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(c, _mm256_loadu_ps(newest + i - j)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(c, _mm256_loadu_ps(newest + i + 8 - j)));
+        }
+        _mm256_storeu_ps(out + i, acc0);
+        _mm256_storeu_ps(out + i + 8, acc1);
+    }
+    for (; i + 8 <= frames; i += 8){
+        __m256 acc = _mm256_setzero_ps();
+        for (int j = 0; j < taps; j++)
+            acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(coeffs[j]), _mm256_loadu_ps(newest + i - j)));
+        _mm256_storeu_ps(out + i, acc);
+    }
+    firKernelScalar(coeffs, taps, x + i, out + i, frames - i);
+}
+
+#endif  // FIR_X86
+
+#if FIR_NEON
+
+static void firKernelNEON(const float* coeffs, int taps, const float* x, float* out, int frames){
+    const float* newest = x + taps - 1;
+    int i = 0;
+    for (; i + 4 <= frames; i += 4){
+        float32x4_t acc = vdupq_n_f32(0.0f);
+        for (int j = 0; j < taps; j++)
+            acc = vaddq_f32(acc, vmulq_n_f32(vld1q_f32(newest + i - j), coeffs[j]));    // no fused multiply-add
+        vst1q_f32(out + i, acc);
+    }
+    firKernelScalar(coeffs, taps, x + i, out + i, frames - i);
+}
+
+#endif  // FIR_NEON
+
+
+struct FirDispatch{
+    const char* name;
+    FirKernel   kernel;
+};
+
+// FIR kernels in this build, widest first
+static const CpuChoice<FirDispatch> FIR_KERNELS[] = {
+#if FIR_X86
+    {CPU_AVX, {"avx", firKernelAVX}},
+    {CPU_SSE, {"sse", firKernelSSE}},
+#elif FIR_NEON
+    {CPU_NEON, {"neon", firKernelNEON}},
+#endif
+    {CPU_ANY, {"scalar", firKernelScalar}},
+};
+
+// Every filter block runs through this one
+static const FirDispatch KERNEL = cpuSelect(FIR_KERNELS, sizeof(FIR_KERNELS) / sizeof(FIR_KERNELS[0]));
+
+
+// ---------------------------------------------------------------------------
+// Filter
+// ---------------------------------------------------------------------------
+
+void firSetCoefficients(FirCoefficients &fir, const float* coeffs, int taps){
+    if (taps > MAX_FIR_TAPS) taps = MAX_FIR_TAPS;
+    if (taps < 1) taps = 1;
+    fir.taps = taps;
+    for (int i = 0; i < MAX_FIR_TAPS; i++)
+        fir.coeffs[i] = i < taps ? coeffs[i] : 0.0f;
+}
+
+
+void firDesignLowpass(FirCoefficients &fir, int taps, float cutoffHz, float sampleRate){
+    if (taps > MAX_FIR_TAPS) taps = MAX_FIR_TAPS;
+    if (taps < 1) taps = 1;
+
+    float coeffs[MAX_FIR_TAPS];
+    double fc = cutoffHz / sampleRate;         // normalized cutoff (cycles/sample)
+    double centre = (taps - 1) / 2.0;
+    double sum = 0.0;
+
+    for (int i = 0; i < taps; i++){
+        double t = i - centre;
+        double sinc = (t == 0.0) ? 2.0 * fc : sin(2.0 * FIR_PI * fc * t) / (FIR_PI * t);
+        double window = (taps > 1) ? 0.54 - 0.46 * cos(2.0 * FIR_PI * i / (taps - 1)) : 1.0;
+        coeffs[i] = sinc * window;
+        sum += coeffs[i];
+    }
+
+    // Unity gain at DC
+    if (sum != 0.0)
+        for (int i = 0; i < taps; i++)
+            coeffs[i] /= sum;
+
+    firSetCoefficients(fir, coeffs, taps);
+}
+
+
+void firReset(FirState &state){
+    memset(state.line, 0, sizeof(state.line));
+}
+
+
+void firProcess(const FirCoefficients &fir, FirState &state,
+                const float* in, float* out, unsigned long frames){
+    const int history = fir.taps - 1;
+
+    while (frames > 0){
+        int chunk = frames < FIR_CHUNK ? (int)frames : FIR_CHUNK;
+
+        // Append the new input after the history, filter, then keep the newest history
+        memcpy(state.line + history, in, chunk * sizeof(float));
+        KERNEL.kernel(fir.coeffs, fir.taps, state.line, out, chunk);
+        memmove(state.line, state.line + chunk, history * sizeof(float));
+
+        in += chunk;
+        out += chunk;
+        frames -= chunk;
+    }
+}
+
+
+const char* firKernelName(){
+    return KERNEL.name;
+}
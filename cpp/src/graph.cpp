@@ -0,0 +1,503 @@
+/*
+ * graph.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the effect graph
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../include/graph.h"
+#include "../include/chain.h"
+#include "../include/menu.h"
+#include "../include/types.h"
+
+static_assert(GRAPH_MAX_CHANNELS >= AudioParams::MAX_CHANNELS, "graph buffers need a pointer per channel");
+static_assert(GRAPH_MAX_NODES <= 32, "node sets are 32 bit masks");
+
+#define QUEUE_FRONT(q) ((unsigned)((q) & 0xffff))
+#define QUEUE_BACK(q)  ((unsigned)(((q) >> 16) & 0xffff))
+#define QUEUE_TAG(q)   ((uint32_t)((q) >> 32))
+#define BIT(n)         (1u << (n))
+
+
+// ---------------------------------------------------------------------------
+// Compiling
+// ---------------------------------------------------------------------------
+
+// Effects that use RtUserData's shared scratch buffers (never run together)
+static bool usesScratch(int effect){
+    return effect != EFFECT_DELAY && effect != EFFECT_REVERB
+        && effect != EFFECT_BITCRUSH && effect != EFFECT_MULTITAP;
+}
+
+struct GraphParser{
+    const std::string &spec;
+    size_t pos;
+    EffectGraph &graph;
+    bool used[NUM_EFFECTS];
+
+    GraphParser(const std::string &text, EffectGraph &out) : spec(text), pos(0), graph(out){
+        for (int i = 0; i < NUM_EFFECTS; i++) used[i] = false;
+    }
+};
+
+// Append a node; returns its index, or -1 when the graph is full
+static int addNode(GraphParser &parser, GraphNodeKind kind){
+    EffectGraph &graph = parser.graph;
+    if (graph.count >= GRAPH_MAX_NODES){
+        fprintf(stderr, "Error: graph has more than %d nodes\n", GRAPH_MAX_NODES);
+        return -1;
+    }
+    GraphNode &node = graph.nodes[graph.count];
+    node = GraphNode();
+    node.kind = kind;
+    return graph.count++;
+}
+
+static int parseSplit(GraphParser &parser, int from);
+
+// Effects and splits in series from node from; returns the last node
+static int parseSeries(GraphParser &parser, int from){
+    int current = from;
+    while (parser.pos < parser.spec.size()){
+        char c = parser.spec[parser.pos];
+        if (c == ']' || c == '|' || c == ':') break;
+        parser.pos++;
+
+        if (c == '['){
+            current = parseSplit(parser, current);
+            if (current < 0) return -1;
+            continue;
+        }
+
+        // An effect, by its menu key
+        EffectChoices choice;
+        bool valid = false, exitFlag = false;
+        if (c != '0') choiceSelect(c, choice, valid, exitFlag);
+        if (!valid || choice.chainLength != 1){
+            fprintf(stderr, "Error: '%c' is not an effect key\n", c);
+            return -1;
+        }
+        EffectType type = choice.chain[0];
+        EffectProcess process = effectProcess(type);
+        if (!process) continue;             // pass through
+        if (parser.used[type]){
+            fprintf(stderr, "Error: %s appears twice (an effect has one set of state)\n", effectName(type));
+            return -1;
+        }
+        parser.used[type] = true;
+
+        int index = addNode(parser, GRAPH_EFFECT);
+        if (index < 0) return -1;
+        GraphNode &node = parser.graph.nodes[index];
+        node.effect = type;
+        node.process = process;
+        node.inputs[0] = current;
+        node.inputCount = 1;
+        current = index;
+    }
+    return current;
+}
+
+// Branches "[a|b|...]" from node from (the '[' already read); returns the mix
+static int parseSplit(GraphParser &parser, int from){
+    int outputs[GRAPH_MAX_BRANCHES];
+    float gains[GRAPH_MAX_BRANCHES];
+    bool given[GRAPH_MAX_BRANCHES];
+    int count = 0;
+    bool weighted = false;
+
+    while (true){
+        if (count >= GRAPH_MAX_BRANCHES){
+            fprintf(stderr, "Error: a split has at most %d branches\n", GRAPH_MAX_BRANCHES);
+            return -1;
+        }
+        int output = parseSeries(parser, from);
+        if (output < 0) return -1;
+
+        float gain = 0.0f;
+        given[count] = false;
+        if (parser.pos < parser.spec.size() && parser.spec[parser.pos] == ':'){
+            const char* start = parser.spec.c_str() + parser.pos + 1;
+            char* end = NULL;
+            gain = strtof(start, &end);
+            if (end == start || !(gain >= -4.0f && gain <= 4.0f)){
+                fprintf(stderr, "Error: invalid branch gain at \"%s\" (-4 to 4)\n", start);
+                return -1;
+            }
+            parser.pos = end - parser.spec.c_str();
+            given[count] = weighted = true;
+        }
+        outputs[count] = output;
+        gains[count] = gain;
+        count++;
+
+        if (parser.pos >= parser.spec.size()){
+            fprintf(stderr, "Error: missing ']'\n");
+            return -1;
+        }
+        char c = parser.spec[parser.pos++];
+        if (c == ']') break;
+        if (c != '|'){
+            fprintf(stderr, "Error: expected '|' or ']' at \"%s\"\n", parser.spec.c_str() + parser.pos - 1);
+            return -1;
+        }
+    }
+
+    // "[abc]" is just a series
+    if (count == 1 && !weighted) return outputs[0];
+
+    int index = addNode(parser, GRAPH_MIX);
+    if (index < 0) return -1;
+    GraphNode &mix = parser.graph.nodes[index];
+    for (int i = 0; i < count; i++){
+        mix.inputs[i] = outputs[i];
+        mix.gains[i] = given[i] ? gains[i] : 1.0f / count;
+    }
+    mix.inputCount = count;
+    return index;
+}
+
+
+// Order edges between scratch users, the after / next sets and the
+// parallel flag. before[i] gets every node i transitively waits for.
+static void orderNodes(EffectGraph &graph, uint32_t* before){
+    before[0] = 0;
+    for (int i = 1; i < graph.count; i++){
+        GraphNode &node = graph.nodes[i];
+        node.after = 0;
+        for (int k = 0; k < node.inputCount; k++)
+            node.after |= BIT(node.inputs[k]);
+
+        before[i] = 0;
+        for (int j = 0; j < i; j++)
+            if (node.after & BIT(j)) before[i] |= before[j] | BIT(j);
+
+        if (node.kind != GRAPH_EFFECT || !usesScratch(node.effect)) continue;
+        for (int j = 1; j < i; j++){
+            const GraphNode &other = graph.nodes[j];
+            if (other.kind != GRAPH_EFFECT || !usesScratch(other.effect) || (before[i] & BIT(j))) continue;
+            node.after |= BIT(j);
+            before[i] |= before[j] | BIT(j);
+        }
+    }
+
+    graph.parallel = false;
+    for (int i = 0; i < graph.count; i++) graph.nodes[i].next = 0;
+    for (int i = 1; i < graph.count; i++){
+        for (int j = 0; j < i; j++)
+            if (graph.nodes[i].after & BIT(j)) graph.nodes[j].next |= BIT(i);
+        for (int j = 1; j < i; j++)
+            if (!(before[i] & BIT(j))) graph.parallel = true;
+    }
+}
+
+
+// Give every node a buffer (see graph.h). Returns -1 if the pool is too small.
+static int assignBuffers(EffectGraph &graph, const uint32_t* before){
+    uint32_t readers[GRAPH_MAX_NODES] = {};
+    for (int i = 1; i < graph.count; i++)
+        for (int k = 0; k < graph.nodes[i].inputCount; k++)
+            readers[graph.nodes[i].inputs[k]] |= BIT(i);
+
+    // Value held by each buffer (-1 = none); the block starts with the input
+    int holds[GRAPH_MAX_BUFFERS + 1];
+    holds[0] = 0;
+    for (int b = 1; b <= GRAPH_MAX_BUFFERS; b++) holds[b] = -1;
+    graph.nodes[0].buffer = 0;
+    graph.buffers = 0;
+
+    for (int i = 1; i < graph.count; i++){
+        GraphNode &node = graph.nodes[i];
+        const int input = node.inputs[0];
+
+        // In place over the first input, if every other reader is done with it
+        bool inPlace = (readers[input] & ~BIT(i) & ~before[i]) == 0;
+        for (int k = 1; k < node.inputCount && inPlace; k++)
+            if (node.inputs[k] == input) inPlace = false;
+
+        int buffer = -1;
+        if (inPlace)
+            buffer = graph.nodes[input].buffer;
+        else{
+            for (int b = 0; b <= GRAPH_MAX_BUFFERS && buffer < 0; b++){
+                int value = holds[b];
+                if (value < 0 || (readers[value] & ~before[i]) == 0) buffer = b;
+            }
+        }
+        if (buffer < 0){
+            fprintf(stderr, "Error: graph needs more than %d buffers\n", GRAPH_MAX_BUFFERS);
+            return -1;
+        }
+
+        node.buffer = buffer;
+        holds[buffer] = i;
+        if (buffer > graph.buffers) graph.buffers = buffer;
+    }
+    return 0;
+}
+
+
+int graphParse(const std::string &spec, EffectGraph &graph){
+    EffectGraph parsed;
+    GraphParser parser(spec, parsed);
+
+    int output = parseSeries(parser, 0);
+    if (output < 0) return -1;
+    if (parser.pos < spec.size()){
+        fprintf(stderr, "Error: unexpected '%c' in graph %s\n", spec[parser.pos], spec.c_str());
+        return -1;
+    }
+
+    uint32_t before[GRAPH_MAX_NODES];
+    orderNodes(parsed, before);
+    if (assignBuffers(parsed, before) < 0) return -1;
+
+    graph = parsed;
+    return 0;
+}
+
+
+int graphBuild(GraphBank &bank, const std::string &spec){
+    int slot = slotAcquire(bank.pool);
+    if (slot < 0){
+        fprintf(stderr, "Error: every graph slot is in use\n");
+        return -1;
+    }
+
+    if (graphParse(spec, bank.graphs[slot]) < 0){
+        slotCancel(bank.pool, slot);
+        return -1;
+    }
+    return slot;
+}
+
+
+int graphLoad(GraphBank &bank, const std::string &spec){
+    int slot = graphBuild(bank, spec);
+    if (slot < 0) return -1;
+    graphSwitch(bank, slot);
+    return 0;
+}
+
+
+void graphReset(GraphBank &bank){
+    bank.active = -1;
+    slotReset(bank.pool, -1);
+}
+
+
+// ---------------------------------------------------------------------------
+// Workers
+// ---------------------------------------------------------------------------
+
+// Make a node ready in the current run
+static void pushReady(GraphRunner &runner, uint32_t tag, int node){
+    uint64_t queue = runner.queue.load(std::memory_order_acquire);
+    while (!runner.queue.compare_exchange_weak(queue, queue + (1ull << 16), std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) {}
+    runner.ready[QUEUE_BACK(queue)].store((uint64_t)tag << 32 | (unsigned)node, std::memory_order_release);
+}
+
+// Take a ready node of run tag
+static bool takeReady(GraphRunner &runner, uint32_t tag, int &node){
+    uint64_t queue = runner.queue.load(std::memory_order_acquire);
+    while (true){
+        if (QUEUE_TAG(queue) != tag || QUEUE_FRONT(queue) >= QUEUE_BACK(queue)) return false;
+        if (runner.queue.compare_exchange_weak(queue, queue + 1, std::memory_order_acq_rel,
+                                               std::memory_order_acquire)) break;
+    }
+
+    // The pusher reserved the entry first and fills it right after
+    std::atomic<uint64_t> &entry = runner.ready[QUEUE_FRONT(queue)];
+    uint64_t value;
+    while (QUEUE_TAG(value = entry.load(std::memory_order_acquire)) != tag)
+        cpuRelax();
+    node = (int)(value & 0xffff);
+    return true;
+}
+
+
+// Process one node
+static void runNode(GraphRunner &runner, int index){
+    const EffectGraph &graph = *runner.graph;
+    const GraphNode &node = graph.nodes[index];
+    const unsigned long frames = runner.frames;
+    const int channels = runner.channels;
+    float* const* out = runner.buffers[node.buffer];
+
+    if (node.kind == GRAPH_EFFECT){
+        float* const* in = runner.buffers[graph.nodes[node.inputs[0]].buffer];
+        if (in != out)
+            for (int ch = 0; ch < channels; ch++)
+                memcpy(out[ch], in[ch], frames * sizeof(float));
+        node.process(out, frames, runner.ud);
+        return;
+    }
+
+    // Mix: the first input scaled (or copied and scaled), then the others added
+    float* const* first = runner.buffers[graph.nodes[node.inputs[0]].buffer];
+    for (int ch = 0; ch < channels; ch++){
+        float* y = out[ch];
+        const float* x = first[ch];
+        const float g = node.gains[0];
+        for (unsigned long i = 0; i < frames; i++)
+            y[i] = g * x[i];
+
+        for (int k = 1; k < node.inputCount; k++){
+            const float* z = runner.buffers[graph.nodes[node.inputs[k]].buffer][ch];
+            const float h = node.gains[k];
+            for (unsigned long i = 0; i < frames; i++)
+                y[i] += h * z[i];
+        }
+    }
+}
+
+
+// Run ready nodes of run tag until every node is done
+static void work(GraphRunner &runner, uint32_t tag){
+    int node;
+    while (runner.remaining.load(std::memory_order_acquire) > 0
+           && runner.run.load(std::memory_order_relaxed) == tag){
+        if (!takeReady(runner, tag, node)){
+            cpuRelax();
+            continue;
+        }
+
+        runNode(runner, node);
+
+        uint32_t next = runner.graph->nodes[node].next;
+        while (next){
+            int j = __builtin_ctz(next);
+            next &= next - 1;
+            if (runner.pending[j].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pushReady(runner, tag, j);
+        }
+        runner.remaining.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+
+// Wait for the run counter to move on from seen; returns the new value
+static uint32_t waitRun(GraphRunner &runner, uint32_t seen){
+    for (int i = 0; i < GRAPH_SPIN; i++){
+        uint32_t run = runner.run.load(std::memory_order_acquire);
+        if (run != seen) return run;
+        cpuRelax();
+    }
+
+    // Announced before the last check; the caller checks for sleepers
+    // after publishing (both seq_cst), so no wake is missed
+    runner.sleeping.fetch_add(1, std::memory_order_seq_cst);
+    uint32_t run;
+    while ((run = runner.run.load(std::memory_order_seq_cst)) == seen)
+        futexWait(runner.run, seen);
+    runner.sleeping.fetch_sub(1, std::memory_order_relaxed);
+    return run;
+}
+
+static void* workerMain(void* arg){
+    GraphRunner &runner = *(GraphRunner*)arg;
+    prefaultStack();
+    AudioPathScope audioPath;
+
+    uint32_t seen = runner.run.load(std::memory_order_acquire);
+    while (true){
+        seen = waitRun(runner, seen);
+        if (!runner.running.load(std::memory_order_acquire)) break;
+        work(runner, seen);
+    }
+    return NULL;
+}
+
+
+void graphInit(GraphRunner &runner, int channels){
+    const size_t frames = RtUserData::MAX_BLOCK_FRAMES;
+    runner.channels = channels;
+    runner.pool.assign(GRAPH_MAX_BUFFERS * channels * frames, 0.0f);
+    for (int b = 1; b <= GRAPH_MAX_BUFFERS; b++)
+        for (int ch = 0; ch < channels; ch++)
+            runner.buffers[b][ch] = runner.pool.data() + ((b - 1) * channels + ch) * frames;
+}
+
+
+int graphStartWorkers(GraphRunner &runner, int threads, const RtThreadConfig &config){
+    graphStopWorkers(runner);
+    if (threads > GRAPH_MAX_THREADS) threads = GRAPH_MAX_THREADS;
+
+    runner.running.store(true, std::memory_order_release);
+    runner.threadCount = 1;
+    while (runner.threadCount < threads){
+        if (startRtThread(&runner.threads[runner.threadCount], config, workerMain, &runner) < 0) break;
+        runner.threadCount++;
+    }
+    return runner.threadCount;
+}
+
+
+void graphStopWorkers(GraphRunner &runner){
+    if (runner.threadCount <= 1) return;
+
+    runner.running.store(false, std::memory_order_release);
+    runner.run.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(runner.run);
+    for (int i = 1; i < runner.threadCount; i++)
+        pthread_join(runner.threads[i], NULL);
+    runner.threadCount = 1;
+}
+
+
+GraphRunner::~GraphRunner(){
+    graphStopWorkers(*this);
+}
+
+
+// ---------------------------------------------------------------------------
+// Audio side
+// ---------------------------------------------------------------------------
+
+void graphSwitch(GraphBank &bank, int slot){
+    if (bank.active >= 0) slotRelease(bank.pool, bank.active);
+    bank.active = slot;
+}
+
+
+void graphRun(GraphRunner &runner, const EffectGraph &graph, float* const* block,
+              unsigned long frames, RtUserData* ud){
+    for (int ch = 0; ch < runner.channels; ch++)
+        runner.buffers[0][ch] = block[ch];
+    runner.graph = &graph;
+    runner.frames = frames;
+    runner.ud = ud;
+
+    if (!graph.parallel || runner.threadCount <= 1){
+        for (int i = 1; i < graph.count; i++)
+            runNode(runner, i);
+    }
+    else{
+        const uint32_t tag = runner.run.load(std::memory_order_relaxed) + 1;
+        runner.queue.store((uint64_t)tag << 32, std::memory_order_relaxed);
+        runner.remaining.store(graph.count - 1, std::memory_order_relaxed);
+        for (int i = 1; i < graph.count; i++)
+            runner.pending[i].store(__builtin_popcount(graph.nodes[i].after & ~BIT(0)), std::memory_order_relaxed);
+        for (int i = 1; i < graph.count; i++)
+            if (graph.nodes[i].after == BIT(0)) pushReady(runner, tag, i);
+
+        // Publish, then work alongside the workers
+        runner.run.store(tag, std::memory_order_seq_cst);
+        if (runner.sleeping.load(std::memory_order_seq_cst) > 0)
+            futexWakeAll(runner.run);
+        work(runner, tag);
+    }
+
+    // The output may have ended up in a pool buffer
+    const int output = graph.nodes[graph.count - 1].buffer;
+    if (output != 0)
+        for (int ch = 0; ch < runner.channels; ch++)
+            memcpy(block[ch], runner.buffers[output][ch], frames * sizeof(float));
+}
@@ -0,0 +1,238 @@
+/*
+ * init.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of DSP state initialization
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include "../include/init.h"
+#include "../include/control.h"
+
+using namespace std;
+
+#define TREM_START_PHASE (0.1f / (2.0f * AudioParams::PI))     // cycles (the tremolo always started at 0.1 rad)
+#define DELAY_FADE_MS    50         // crossfade time of a delay time change
+
+
+// Size and reset one effect's oversampling states
+static void initOversample(RtUserData &ud, ArenaVector<OversampleState> &states, int factor, int channels){
+    states.resize(channels);
+    for (int ch = 0; ch < channels; ch++)
+        oversampleReset(ud.oversampler, states[ch], factor);
+}
+
+// Size and clear one line per channel, for distances up to maxMs
+static void initLines(ArenaVector<DelayLine> &lines, float maxMs, unsigned extra, int rate, int channels){
+    lines.resize(channels);
+    for (int ch = 0; ch < channels; ch++)
+        delayInit(lines[ch], (unsigned)(maxMs * rate / 1000) + extra);
+}
+
+// Reserve the arena for what initData allocates: a throwaway state is
+// built the same way first, with an arena that only measures
+static void reserveArena(RtUserData &ud, AudioParams &audioParams, EffectChoices &effectChoice){
+    RtUserData* sizing = new RtUserData();
+    sizing->impulse = ud.impulse;
+    sizing->arena.measuring = true;
+    initData(*sizing, audioParams, effectChoice);
+
+    arenaInit(ud.arena, sizing->arena.used + ARENA_SLACK);
+    delete sizing;
+}
+
+// initialize data
+void initData(RtUserData &ud, AudioParams &audioParams, EffectChoices &effectChoice){
+    ud.params = &audioParams;
+    ud.effects = &effectChoice;
+    ud.channels = audioParams.CHANNELS;
+    ud.format = audioParams.FORMAT;
+
+    // Every line and buffer sized below comes out of the arena
+    if (!ud.arena.base && !ud.arena.measuring)
+        reserveArena(ud, audioParams, effectChoice);
+    ArenaScope scope(ud.arena);
+ 
+    // Everything below is sized / timed from the negotiated stream format
+    const int rate = audioParams.SAMPLE_RATE;
+    const int channels = audioParams.CHANNELS;
+
+    // Parameters each effect reads, copied into its state block
+    snapshotParams(&ud);
+
+    ud.trem.lfo.wave = audioParams.TREM_WAVE;
+    lfoSetRate(ud.trem.lfo, audioParams.TREM_FREQ, rate);
+    lfoSetPhase(ud.trem.lfo, TREM_START_PHASE);
+
+    ud.phaser.lfo.wave = audioParams.PHASER_WAVE;
+    lfoSetRate(ud.phaser.lfo, audioParams.PHASER_RATE, rate);
+    lfoSetPhase(ud.phaser.lfo, 0.0f);
+    lfoSetPhase(ud.chorus.lfo, 0.0f);
+    lfoSetPhase(ud.flanger.lfo, 0.0f);
+    lfoSetPhase(ud.vibrato.lfo, 0.0f);
+
+    lfoSetRate(ud.chorus.lfo, audioParams.CHORUS_RATE, rate);
+    lfoSetRate(ud.flanger.lfo, audioParams.FLANGER_RATE, rate);
+    lfoSetRate(ud.vibrato.lfo, audioParams.VIBRATO_RATE, rate);
+ 
+    initLines(ud.delay.lines, AudioParams::DELAY_MAX_MS, 2, rate, channels);
+    ud.delay.target = delayDistance(audioParams.DELAY_MS, rate);
+    ud.delay.distance = ud.delay.target;
+    ud.delay.nextDistance = ud.delay.distance;
+    ud.delay.fadeFrames = max(1, DELAY_FADE_MS * rate / 1000);
+    ud.delay.fadeRemaining = 0;
+
+    multitapInit(ud.multitap.delay, audioParams.TAPS, audioParams.TAP_BPM, rate, channels);
+
+    // Swept lines are read a block at a time, a block behind the write position
+    initLines(ud.chorus.lines, AudioParams::MOD_MAX_MS, RtUserData::MAX_BLOCK_FRAMES, rate, channels);
+    initLines(ud.flanger.lines, AudioParams::MOD_MAX_MS, RtUserData::MAX_BLOCK_FRAMES, rate, channels);
+    initLines(ud.vibrato.lines, AudioParams::MOD_MAX_MS, RtUserData::MAX_BLOCK_FRAMES, rate, channels);
+ 
+    fdnInit(ud.reverb.fdn, rate);
+    fdnSetDecay(ud.reverb.fdn, audioParams.REVERB_TIME, audioParams.REVERB_DAMPING, rate);
+ 
+    ud.bitcrush.count = 0;
+    for (int ch = 0; ch < AudioParams::MAX_CHANNELS; ch++)
+        ud.bitcrush.sample[ch] = 0.0f;
+
+    ud.fuzz.attackFrames = max(1, (int)((AudioParams::FUZZ_ATTACK / 1000) * rate));
+
+    ShaperSettings od;
+    od.drive = audioParams.OD_DRIVE;
+    od.factor = audioParams.OD_FACTOR;
+    shaperInit(ud.shapers[SHAPER_OD], SHAPER_OD, od);
+
+    ShaperSettings fuzz;
+    fuzz.drive = audioParams.FUZZ_DRIVE;
+    fuzz.factor = audioParams.FUZZ_FACTOR;
+    fuzz.maxBias = audioParams.FUZZ_MAX_BIAS;
+    shaperInit(ud.shapers[SHAPER_FUZZ], SHAPER_FUZZ, fuzz);
+
+    convolverInit(ud.cabinet.convolver, ud.impulse, rate, channels);
+
+    graphInit(ud.graphRunner, channels);
+    graphReset(ud.graphs);
+
+    oversamplerInit(ud.oversampler);
+    initOversample(ud, ud.overdrive.oversample, audioParams.OD_OVERSAMPLE, channels);
+    initOversample(ud, ud.distortion.oversample, audioParams.DIST_OVERSAMPLE, channels);
+    initOversample(ud, ud.fuzz.oversample, audioParams.FUZZ_OVERSAMPLE, channels);
+
+    if (audioParams.TONE_TAPS > 0)
+        firDesignLowpass(ud.toneFir, audioParams.TONE_TAPS, audioParams.TONE_CUTOFF, rate);
+    else
+        firSetCoefficients(ud.toneFir, audioParams.TONE_COEFFICIENTS, AudioParams::TONE_SIZE);
+ 
+    return;
+}
+
+
+// reset DSP data
+void resetData(RtUserData &ud){
+    // Settle live control: apply queued commands and finish running ramps
+    if (ud.params){
+        applyControl(&ud);
+        advanceRamps(&ud, ~0UL);
+    }
+
+    for (size_t ch = 0; ch < ud.delay.lines.size(); ch++){
+        delayReset(ud.delay.lines[ch]);
+        delayReset(ud.chorus.lines[ch]);
+        delayReset(ud.flanger.lines[ch]);
+        delayReset(ud.vibrato.lines[ch]);
+    }
+    for (int ch = 0; ch < AudioParams::MAX_CHANNELS; ch++){
+        ud.delay.current[ch] = DelayTap();
+        ud.delay.next[ch] = DelayTap();
+    }
+    ud.delay.distance = ud.delay.target;
+    ud.delay.nextDistance = ud.delay.distance;
+    ud.delay.fadeRemaining = 0;
+
+    multitapReset(ud.multitap.delay);
+    fdnReset(ud.reverb.fdn);
+    convolverReset(ud.cabinet.convolver);
+
+    for (size_t ch = 0; ch < ud.overdrive.oversample.size(); ch++){
+        oversampleReset(ud.oversampler, ud.overdrive.oversample[ch], ud.overdrive.oversample[ch].factor);
+        oversampleReset(ud.oversampler, ud.distortion.oversample[ch], ud.distortion.oversample[ch].factor);
+        oversampleReset(ud.oversampler, ud.fuzz.oversample[ch], ud.fuzz.oversample[ch].factor);
+    }
+
+    ud.bitcrush.count = 0;
+    for (int ch = 0; ch < AudioParams::MAX_CHANNELS; ch++){
+        ud.bitcrush.sample[ch] = 0.0f;
+        ud.fuzz.average[ch] = 0.0f;
+        ud.fuzz.dcInput[ch] = 0.0f;
+        ud.fuzz.dcOutput[ch] = 0.0f;
+        firReset(ud.overdrive.toneState[ch]);
+        firReset(ud.distortion.toneState[ch]);
+        firReset(ud.fuzz.toneState[ch]);
+    }
+
+    lfoSetPhase(ud.trem.lfo, TREM_START_PHASE);
+    lfoSetPhase(ud.phaser.lfo, 0.0f);
+    lfoSetPhase(ud.chorus.lfo, 0.0f);
+    lfoSetPhase(ud.flanger.lfo, 0.0f);
+    lfoSetPhase(ud.vibrato.lfo, 0.0f);
+    for (int ch = 0; ch < AudioParams::MAX_CHANNELS; ch++){
+        for (int st = 0; st < AudioParams::PHASER_STAGES; st++){
+            ud.phaser.input[ch][st] = 0.0f;
+            ud.phaser.output[ch][st] = 0.0f;
+        }
+        ud.phaser.last[ch] = 0.0f;
+    }
+}
+
+
+// set the multi-tap delay tempo from the command line
+int setTempo(const string &bpm, AudioParams &audioParams){
+    char* end = NULL;
+    float value = strtof(bpm.c_str(), &end);
+    if (bpm.empty() || *end != '\0' || !(value >= 20.0f && value <= 300.0f)){
+        fprintf(stderr, "Error: tempo must be 20 to 300 BPM (got %s)\n", bpm.c_str());
+        return -1;
+    }
+    audioParams.TAP_BPM = value;
+    return 0;
+}
+
+
+// set oversampling factors from the command line
+int setOversampling(const string &spec, AudioParams &audioParams){
+    istringstream items(spec);
+    string item;
+
+    while (getline(items, item, ',')){
+        string name = "all";
+        string value = item;
+        size_t equals = item.find('=');
+        if (equals != string::npos){
+            name = item.substr(0, equals);
+            value = item.substr(equals + 1);
+        }
+
+        char* end = NULL;
+        long factor = strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || (factor != 1 && factor != 2 && factor != 4 && factor != 8)){
+            fprintf(stderr, "Error: oversampling factor must be 1, 2, 4 or 8 (got %s)\n", value.c_str());
+            return -1;
+        }
+
+        if (name == "od" || name == "all") audioParams.OD_OVERSAMPLE = factor;
+        if (name == "dist" || name == "all") audioParams.DIST_OVERSAMPLE = factor;
+        if (name == "fuzz" || name == "all") audioParams.FUZZ_OVERSAMPLE = factor;
+        if (name != "od" && name != "dist" && name != "fuzz" && name != "all"){
+            fprintf(stderr, "Error: unknown effect %s in --oversample (od, dist or fuzz)\n", name.c_str());
+            return -1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,132 @@
+/*
+ * lfo.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the LFO engine
+*/
+
+#include <cmath>
+#include "../include/lfo.h"
+
+#define LFO_PI         3.14159265358979323846
+#define LFO_FRAC_BITS  (32 - LFO_TABLE_BITS)
+
+static const float FRAC_SCALE = 1.0f / (1u << LFO_FRAC_BITS);
+
+
+// Band limited wavetables. Entry i + 1 holds the wave at i / LFO_TABLE_SIZE
+// cycles; one guard entry before and two after make every interpolation
+// read contiguous.
+struct LfoTables{
+    float wave[NUM_LFO_WAVES][LFO_TABLE_SIZE + 3];
+
+    LfoTables(){
+        for (int w = 0; w < NUM_LFO_WAVES; w++){
+            float* table = wave[w] + 1;
+            double peak = 0.0;
+
+            for (int i = 0; i < LFO_TABLE_SIZE; i++){
+                double x = 2.0 * LFO_PI * i / LFO_TABLE_SIZE;
+                double sum = 0.0;
+
+                if (w == LFO_SINE)
+                    sum = sin(x);
+                else{
+                    for (int n = 1; n <= LFO_HARMONICS; n++){
+                        // Lanczos sigma factor against overshoot at the edges
+                        double t = LFO_PI * n / (LFO_HARMONICS + 1);
+                        double sigma = sin(t) / t;
+
+                        if (w == LFO_TRIANGLE && (n & 1))
+                            sum += sigma * ((n & 2) ? -1.0 : 1.0) * sin(n * x) / (n * n);
+                        else if (w == LFO_SAW)
+                            sum += sigma * ((n & 1) ? 1.0 : -1.0) * sin(n * (x - LFO_PI)) / n;
+                        else if (w == LFO_SQUARE && (n & 1))
+                            sum += sigma * sin(n * x) / n;
+                    }
+                }
+
+                table[i] = (float)sum;
+                if (fabs(sum) > peak) peak = fabs(sum);
+            }
+
+            // Full scale
+            for (int i = 0; i < LFO_TABLE_SIZE; i++)
+                table[i] = (float)(table[i] / peak);
+
+            table[-1] = table[LFO_TABLE_SIZE - 1];
+            table[LFO_TABLE_SIZE] = table[0];
+            table[LFO_TABLE_SIZE + 1] = table[1];
+        }
+    }
+};
+
+// Built once at startup, before main
+static const LfoTables TABLES;
+
+
+void lfoSetRate(Lfo &lfo, float hz, float sampleRate){
+    double increment = (double)hz / sampleRate * 4294967296.0;
+    if (increment < 0.0) increment = 0.0;
+    if (increment > 2147483648.0) increment = 2147483648.0;     // Nyquist
+    lfo.increment = (uint32_t)increment;
+}
+
+
+void lfoSetPhase(Lfo &lfo, float cycles){
+    cycles -= floorf(cycles);
+    lfo.phase = (uint32_t)(cycles * 4294967296.0);
+}
+
+
+// Table lookup at a fixed-point phase
+static inline float lookup(const float* table, LfoInterp interp, uint32_t phase){
+    const float* p = table + 1 + (phase >> LFO_FRAC_BITS);
+    float frac = (phase & ((1u << LFO_FRAC_BITS) - 1)) * FRAC_SCALE;
+
+    if (interp == LFO_LINEAR)
+        return p[0] + frac * (p[1] - p[0]);
+
+    // Catmull-Rom through p[-1] .. p[2]
+    float a = 0.5f * (p[1] - p[-1]);
+    float b = p[-1] - 2.5f * p[0] + 2.0f * p[1] - 0.5f * p[2];
+    float c = 0.5f * (p[2] - p[-1]) + 1.5f * (p[0] - p[1]);
+    return p[0] + frac * (a + frac * (b + frac * c));
+}
+
+
+float lfoValue(const Lfo &lfo){
+    return lookup(TABLES.wave[lfo.wave], lfo.interp, lfo.phase);
+}
+
+
+void lfoRender(Lfo &lfo, float* out, unsigned long frames){
+    const float* table = TABLES.wave[lfo.wave];
+    const uint32_t increment = lfo.increment;
+    uint32_t phase = lfo.phase;
+
+    if (lfo.interp == LFO_LINEAR){
+        for (unsigned long i = 0; i < frames; i++){
+            out[i] = lookup(table, LFO_LINEAR, phase);
+            phase += increment;
+        }
+    }
+    else{
+        for (unsigned long i = 0; i < frames; i++){
+            out[i] = lookup(table, LFO_CUBIC, phase);
+            phase += increment;
+        }
+    }
+
+    lfo.phase = phase;
+}
+
+
+const char* lfoWaveName(LfoWave wave){
+    static const char* NAMES[NUM_LFO_WAVES] = {"sine", "triangle", "saw", "square"};
+    if (wave < 0 || wave >= NUM_LFO_WAVES) return "unknown";
+    return NAMES[wave];
+}
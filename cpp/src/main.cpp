@@ -12,6 +12,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <alsa/asoundlib.h>
+#include <atomic>
+#include <chrono>
+#include <pthread.h>
 #include <limits>
 #include <string>
 #include <poll.h>
@@ -23,6 +26,13 @@
 
 #include "../include/menu.h"
 #include "../include/callback.h"
+#include "../include/control.h"
+#include "../include/engine.h"
+#include "../include/init.h"
+#include "../include/metrics.h"
+#include "../include/pcm.h"
+#include "../include/preset.h"
+#include "../include/rtthread.h"
 #include "../include/types.h"
 
 using namespace std;
@@ -30,201 +40,543 @@ using namespace std;
 // User Definitions
 #define FRAMES_PER_BUFFER 512
 #define BUFFER_MULT 4
-const bool DEBUG = 0;
+#define LATENCY_CHECK_BLOCKS 16     // query snd_pcm_delay every this many blocks (power of two)
+#define LOW_LATENCY_PERIODS 2       // periods per buffer in low latency mode
+#define MIN_PERIOD 32               // smallest period tried by the latency probe
+#define PROBE_MS 500                // how long each probed period has to run cleanly
+#define BACKOFF_XRUNS 3             // this many XRUNs ...
+#define BACKOFF_WINDOW_MS 2000      // ... within this time doubles the period
+#define BACKOFF_CHECK_MS 100        // how often the control thread looks for a back-off request
 
 const char* DEVICE_NAME = "hw:0,0";
 
-// function prototypes
-int setupPCM(const char* device, snd_pcm_t** handle, snd_pcm_stream_t stream,
-        unsigned int channels, unsigned int rate, snd_pcm_uframes_t period,
-        snd_pcm_uframes_t buffer);
-
-void initData(RtUserData &ud, AudioParams &audioParams, EffectChoices &effectChoice);
+// Command line options
+struct StreamOptions{
+    RtThreadConfig audioThread;
+    const char* statsPath = "/tmp/audio_effects.stats";
+    int statsIntervalMs = 1000;     // 0 = no stats file
+    bool mmap = false;              // process straight from/into the driver ring buffers
+    bool lowLatency = false;        // linked PCMs, probed period, back-off on XRUNs
+    unsigned int rate = 44100;      // requested; the device's nearest rate is used
+    unsigned int channels = 2;
+    SampleFormat format = FORMAT_S16;
+    bool anyFormat = false;         // --format auto
+    const char* irPath = NULL;      // impulse response for the cabinet effect
+    const char* oversample = NULL;  // oversampling of the nonlinear effects
+    const char* taps = NULL;        // multi-tap delay pattern
+    const char* bpm = NULL;         // tempo of its note division taps
+    int instances = 1;              // independent signal paths the channels are split between
+    int threads = 1;                // threads processing them, the audio thread included
+    const char* graph = NULL;       // effect graph played instead of the menu chain
+    int graphThreads = 1;           // threads running its branches, the audio thread included
+    const char* presetsPath = NULL; // preset bank the "preset" command picks from
+    const char* preset = NULL;      // preset to start with
+};
+
+// Everything the audio thread needs
+struct AudioThreadArgs{
+    RtUserData *ud;
+    Engine *engine;                 // set when running several instances
+    snd_pcm_t *inHandle;
+    snd_pcm_t *outHandle;
+    PcmConfig *pcm;
+    snd_pcm_uframes_t maxPeriod;    // size of inputBlock / outputBlock in frames
+    void *inputBlock;               // interleaved frames in the negotiated format
+    void *outputBlock;
+    Metrics *metrics;
+    std::chrono::steady_clock::time_point xrunWindowStart;
+    int xrunsInWindow;
+    std::atomic<bool> running;
+    std::atomic<bool> backoff;      // XRUNs keep coming: the loop has stopped for a longer period
+};
 
-void resetData(RtUserData &ud);
+// function prototypes
+int parseOptions(int argc, char** argv, StreamOptions &options);
 
 void stream(RtUserData &ud, AudioParams &audioParams,
 		EffectChoices &effectChoice,
 	       	snd_pcm_t *inHandle, snd_pcm_t *outHandle,
-		snd_pcm_uframes_t period);
+		PcmConfig &pcm, const StreamOptions &options,
+		Engine *engine, std::vector<unsigned char> &inputBlock,
+		std::vector<unsigned char> &outputBlock, const Preset *preset);
+
+void prefaultUserData(RtUserData &ud);
+
+void* audioThread(void* arg);
+
+void rwLoop(AudioThreadArgs &args);
+
+void mmapLoop(AudioThreadArgs &args);
+
+void backOff(AudioThreadArgs &args);
 
 
 // main function
-int main(){
+int main(int argc, char** argv){
     // Declare stream parameters
     snd_pcm_t *inHandle, *outHandle;
     AudioParams audioParams;
     EffectChoices effectChoice;
     RtUserData userData;
+    StreamOptions options;
+
+    if (parseOptions(argc, argv, options) < 0) return 1;
+    if (options.irPath && loadImpulseResponse(options.irPath, userData.impulse) < 0) return 1;
+    if (options.oversample && setOversampling(options.oversample, audioParams) < 0) return 1;
+    if (options.taps && multitapParse(options.taps, audioParams.TAPS) < 0) return 1;
+    if (options.bpm && setTempo(options.bpm, audioParams) < 0) return 1;
+    if (options.graph){
+        static EffectGraph check;
+        if (graphParse(options.graph, check) < 0) return 1;
+    }
+
+    // Preset bank; the starting preset's parameters and taps are the
+    // defaults, its chain or graph is queued when streaming starts
+    static PresetBank presets;
+    const Preset *preset = NULL;
+    if (options.presetsPath && presetLoadBank(options.presetsPath, presets) < 0) return 1;
+    if (options.preset){
+        preset = presetFind(presets, options.preset);
+        if (!preset){
+            fprintf(stderr, "Error: no preset %s in %s\n", options.preset, options.presetsPath);
+            return 1;
+        }
+        EffectChoices unused;
+        presetApply(*preset, audioParams, unused);
+    }
     
     // setup PCM device
-    snd_pcm_uframes_t period = FRAMES_PER_BUFFER;
-    snd_pcm_uframes_t buffer = FRAMES_PER_BUFFER * BUFFER_MULT;
+    PcmConfig pcm;
+    pcm.rate = options.rate;
+    pcm.channels = options.channels;
+    pcm.maxChannels = AudioParams::MAX_CHANNELS * options.instances;  // engineInit checks each instance
+    pcm.format = options.format;
+    pcm.anyFormat = options.anyFormat;
+    pcm.period = FRAMES_PER_BUFFER;
+    pcm.periods = BUFFER_MULT;
+    if (options.lowLatency){
+        pcm.linked = true;
+        pcm.periods = LOW_LATENCY_PERIODS;
+    }
 
-    if (setupPCM(DEVICE_NAME, &inHandle, SND_PCM_STREAM_CAPTURE, 2, 44100, period, buffer) < 0) return 1;
-    if (setupPCM(DEVICE_NAME, &outHandle, SND_PCM_STREAM_PLAYBACK, 2, 44100, period, buffer) < 0) return 1;
+    // mmap access if asked for and supported, read/write otherwise
+    if (options.mmap){
+        PcmConfig request = pcm;
+        pcm.access = SND_PCM_ACCESS_MMAP_INTERLEAVED;
+        if (openDuplex(DEVICE_NAME, &inHandle, &outHandle, pcm) < 0){
+            fprintf(stderr, "mmap access not available, falling back to read/write\n");
+            options.mmap = false;
+            pcm = request;
+        }
+    }
+
+    if (!options.mmap && openDuplex(DEVICE_NAME, &inHandle, &outHandle, pcm) < 0) return 1;
 
     snd_pcm_nonblock(inHandle, 1);
     snd_pcm_nonblock(outHandle, 1);
+
+    // find the smallest period that streams without XRUNs
+    if (options.lowLatency){
+        if (probePeriod(inHandle, outHandle, pcm, MIN_PERIOD, FRAMES_PER_BUFFER, PROBE_MS) < 0)
+            fprintf(stderr, "Warning: XRUNs at every period, using %lu frames\n", pcm.period);
+        printf("Low latency: period %lu frames x %u, ~%.2f ms round trip\n",
+               pcm.period, pcm.periods, pcmLatencyMs(pcm));
+    }
    
-    initData(userData, audioParams, effectChoice);
+    // The whole pipeline runs at whatever the device negotiated
+    audioParams.SAMPLE_RATE = pcm.rate;
+    audioParams.CHANNELS = pcm.channels;
+    audioParams.FORMAT = pcm.format;
+    printf("Stream: %u Hz, %u channels, %s\n", pcm.rate, pcm.channels, sampleFormatName(pcm.format));
+
+    // Several instances: the channels are split between them and they run
+    // on the engine's worker pool
+    static Engine engine;
+    Engine *instances = NULL;
+    if (options.instances > 1){
+        EngineConfig config;
+        config.threads = options.threads;
+        config.worker = options.audioThread;
+        config.pin = options.audioThread.cpu >= 0;
+        if (engineInit(engine, config, options.instances, audioParams, effectChoice,
+                       userData.impulse, FRAMES_PER_BUFFER) < 0) return 1;
+        instances = &engine;
+        for (size_t i = 0; i < engine.instances.size(); i++)
+            engine.instances[i]->ud.presets = &presets;
+        printf("Engine: %d instances of %d channels, %d threads\n", options.instances,
+               audioParams.CHANNELS / options.instances, engine.threads);
+    }
+    else{
+        initData(userData, audioParams, effectChoice);
+        userData.presets = &presets;
+        if (options.graph || options.presetsPath)
+            graphStartWorkers(userData.graphRunner, options.graphThreads, options.audioThread);
+    }
+
+    // Period buffers of the audio thread, shared by every session
+    const size_t blockBytes = FRAMES_PER_BUFFER * audioParams.CHANNELS * sampleBytes(audioParams.FORMAT);
+    std::vector<unsigned char> inputBlock(blockBytes);
+    std::vector<unsigned char> outputBlock(blockBytes);
 
     // begin main loop
     while (true) {
         bool keepRunning = menuFunction(effectChoice);
         if (!keepRunning) break;
-        stream(userData, audioParams, effectChoice, inHandle, outHandle, period);
+        stream(userData, audioParams, effectChoice, inHandle, outHandle, pcm, options, instances,
+               inputBlock, outputBlock, preset);
     }
+
+    if (instances) engineShutdown(engine);
 }
 
 
-// setup and open pcm
-int setupPCM(const char* device, snd_pcm_t** handle, snd_pcm_stream_t stream,
-	     unsigned int channels, unsigned int rate,
-	     snd_pcm_uframes_t period, snd_pcm_uframes_t buffer){
-    
-    int err = snd_pcm_open(handle, device, stream, 0);
-    if (err < 0) {
-        fprintf(stderr, "Error opening PCM device: %s\n", snd_strerror(err));
-        return err;
+// parse command line options
+int parseOptions(int argc, char** argv, StreamOptions &options){
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--rt-priority" && hasValue)
+            options.audioThread.priority = atoi(argv[++i]);
+        else if (arg == "--cpu" && hasValue)
+            options.audioThread.cpu = atoi(argv[++i]);
+        else if (arg == "--no-mlock")
+            options.audioThread.lockMemory = false;
+        else if (arg == "--stats" && hasValue)
+            options.statsPath = argv[++i];
+        else if (arg == "--stats-interval" && hasValue)
+            options.statsIntervalMs = atoi(argv[++i]);
+        else if (arg == "--mmap")
+            options.mmap = true;
+        else if (arg == "--low-latency")
+            options.lowLatency = true;
+        else if (arg == "--ir" && hasValue)
+            options.irPath = argv[++i];
+        else if (arg == "--oversample" && hasValue)
+            options.oversample = argv[++i];
+        else if (arg == "--taps" && hasValue)
+            options.taps = argv[++i];
+        else if (arg == "--bpm" && hasValue)
+            options.bpm = argv[++i];
+        else if (arg == "--instances" && hasValue)
+            options.instances = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue)
+            options.threads = atoi(argv[++i]);
+        else if (arg == "--graph" && hasValue)
+            options.graph = argv[++i];
+        else if (arg == "--graph-threads" && hasValue)
+            options.graphThreads = atoi(argv[++i]);
+        else if (arg == "--presets" && hasValue)
+            options.presetsPath = argv[++i];
+        else if (arg == "--preset" && hasValue)
+            options.preset = argv[++i];
+        else if (arg == "--rate" && hasValue)
+            options.rate = atoi(argv[++i]);
+        else if (arg == "--channels" && hasValue)
+            options.channels = atoi(argv[++i]);
+        else if (arg == "--format" && hasValue){
+            string name = argv[++i];
+            options.anyFormat = name == "auto";
+            if (!options.anyFormat){
+                options.format = sampleFormatByName(name);
+                if (options.format == NUM_FORMATS){
+                    fprintf(stderr, "Error: unknown format %s (s16, s24, s32, float or auto)\n", name.c_str());
+                    return -1;
+                }
+            }
+        }
+        else{
+            fprintf(stderr, "Usage: %s [--rt-priority N (0 = normal)] [--cpu N] [--no-mlock]\n"
+                            "          [--stats FILE] [--stats-interval MS (0 = off)] [--mmap]\n"
+                            "          [--low-latency] [--rate HZ] [--channels N]\n"
+                            "          [--format s16|s24|s32|float|auto] [--ir FILE]\n"
+                            "          [--oversample N | od=N,dist=N,fuzz=N (N = 1, 2, 4, 8)]\n"
+                            "          [--taps PATTERN] [--bpm BPM]\n"
+                            "          [--instances N] [--threads N]\n"
+                            "          [--graph ROUTING] [--graph-threads N]\n"
+                            "          [--presets FILE] [--preset NAME]\n", argv[0]);
+            return -1;
+        }
     }
 
-    snd_pcm_hw_params_t* params;
-
-    snd_pcm_hw_params_alloca(&params);
-    snd_pcm_hw_params_any(*handle, params);
-    snd_pcm_hw_params_set_access(*handle, params, SND_PCM_ACCESS_RW_INTERLEAVED);
-    snd_pcm_hw_params_set_format(*handle, params, SND_PCM_FORMAT_S16_LE);
-    snd_pcm_hw_params_set_channels(*handle, params, channels);
-    snd_pcm_hw_params_set_rate(*handle, params, rate, 0);
-    snd_pcm_hw_params_set_period_size_near(*handle, params, &period, 0);
-    snd_pcm_hw_params_set_buffer_size_near(*handle, params, &buffer);
-    err = snd_pcm_hw_params(*handle, params);
-    if (err < 0) {
-        fprintf(stderr, "Error setting input PCM parameters: %s\n", snd_strerror(err));
-        snd_pcm_close(*handle);
-        return err;
+    if (options.audioThread.priority < 0 || options.audioThread.priority > 99){
+        fprintf(stderr, "Error: --rt-priority must be 0-99\n");
+        return -1;
+    }
+    if (options.rate < 8000 || options.rate > 192000){
+        fprintf(stderr, "Error: --rate must be 8000-192000\n");
+        return -1;
+    }
+    if (options.instances < 1 || options.instances > ENGINE_MAX_INSTANCES){
+        fprintf(stderr, "Error: --instances must be 1-%d\n", ENGINE_MAX_INSTANCES);
+        return -1;
+    }
+    if (options.threads < 1 || options.threads > ENGINE_MAX_THREADS){
+        fprintf(stderr, "Error: --threads must be 1-%d\n", ENGINE_MAX_THREADS);
+        return -1;
     }
-    snd_pcm_prepare(*handle);
+    if (options.graphThreads < 1 || options.graphThreads > GRAPH_MAX_THREADS){
+        fprintf(stderr, "Error: --graph-threads must be 1-%d\n", GRAPH_MAX_THREADS);
+        return -1;
+    }
+    if (options.preset && !options.presetsPath){
+        fprintf(stderr, "Error: --preset needs a --presets bank\n");
+        return -1;
+    }
+    if (options.channels < 1 || options.channels > AudioParams::MAX_CHANNELS * (unsigned)options.instances){
+        fprintf(stderr, "Error: --channels must be 1-%d (%d per instance)\n",
+                AudioParams::MAX_CHANNELS * options.instances, AudioParams::MAX_CHANNELS);
+        return -1;
+    }
+    return 0;
+}
+
+
+// touch the DSP state so the audio path never page faults on it
+void prefaultUserData(RtUserData &ud){
+    prefaultBuffer(&ud, sizeof(ud));
+    prefaultBuffer(ud.arena.base, ud.arena.used);     // every vector initData sized
+}
+
 
-    if (DEBUG){
-        snd_pcm_uframes_t actual_period, actual_buffer;
-        snd_pcm_hw_params_get_period_size(params, &actual_period, 0);
-        snd_pcm_hw_params_get_buffer_size(params, &actual_buffer);
-        printf("Period: %lu, Buffer: %lu\n", actual_period, actual_buffer);
+void stream(RtUserData &userData, AudioParams &audioParams,
+            EffectChoices &effectChoice,
+            snd_pcm_t *inHandle, snd_pcm_t *outHandle,
+	    PcmConfig &pcm, const StreamOptions &options,
+	    Engine *engine, std::vector<unsigned char> &inputBlock,
+	    std::vector<unsigned char> &outputBlock, const Preset *preset){
+    // wait until user stops this session; then return to menu
+    printf("Streaming... Press ENTER to stop and return to menu\n");	
+    printControlHelp();
+    if (options.graph)
+        printf("Graph %s (in place of the menu chain until a \"chain\" command)\n", options.graph);
+    if (preset)
+        printf("Preset %s\n", preset->name);
+    if (engine)
+        printf("  <n>: <command>    send it to instance n only (1-%d)\n",
+               (int)engine->instances.size());
+
+    std::string lineBuffer;
+
+    // Make sure the audio thread never page faults on its buffers
+    prefaultBuffer(inputBlock.data(), inputBlock.size());
+    prefaultBuffer(outputBlock.data(), outputBlock.size());
+    if (engine){
+        engineSetEffects(*engine, effectChoice);
+        for (size_t i = 0; i < engine->instances.size(); i++){
+            EngineInstance &instance = *engine->instances[i];
+            if (options.graph) graphLoad(instance.ud.graphs, options.graph);
+            if (preset) sendPreset(instance.ud, *preset);
+            prefaultUserData(instance.ud);
+        }
+    }
+    else{
+        if (options.graph) graphLoad(userData.graphs, options.graph);
+        if (preset) sendPreset(userData, *preset);
+        prefaultUserData(userData);
     }
 
-    // set sw params
-    snd_pcm_sw_params_t* sw_params;
-    snd_pcm_sw_params_malloc(&sw_params);
-    snd_pcm_sw_params_current(*handle, sw_params);
+    // Metrics, exported periodically to the stats file
+    Metrics metrics;
+    metricsReset(metrics, audioParams.SAMPLE_RATE);
+    MetricsExporter exporter;
+    startMetricsExporter(exporter, metrics, options.statsPath, options.statsIntervalMs);
+
+    AudioThreadArgs args;
+    args.ud = &userData;
+    args.engine = engine;
+    args.metrics = &metrics;
+    args.inHandle = inHandle;
+    args.outHandle = outHandle;
+    args.pcm = &pcm;
+    args.maxPeriod = FRAMES_PER_BUFFER;
+    args.xrunWindowStart = std::chrono::steady_clock::now();
+    args.xrunsInWindow = 0;
+    args.inputBlock = inputBlock.data();
+    args.outputBlock = outputBlock.data();
+    args.running = true;
+    args.backoff = false;
+
+    // Audio I/O runs on its own thread; this thread handles the keyboard
+    pthread_t thread;
+    bool threadStarted = startRtThread(&thread, options.audioThread, audioThread, &args) == 0;
+    bool streaming = threadStarted;
+
+    struct pollfd pfd;
+    pfd.fd = STDIN_FILENO; pfd.events = POLLIN;
 
+    while (streaming){
+        int ret = poll(&pfd, 1, pcm.linked ? BACKOFF_CHECK_MS : -1);
+
+        // the audio thread stopped for a longer period: restart it with one
+        if (args.backoff.load(std::memory_order_acquire)){
+            pthread_join(thread, NULL);
+            backOff(args);
+            args.backoff = false;
+            threadStarted = startRtThread(&thread, options.audioThread, audioThread, &args) == 0;
+            streaming = threadStarted;
+        }
+        if (ret <= 0 || !(pfd.revents & POLLIN)) continue;
+
+        // check for enter (empty line stops) or a live control command
+        char buf[256];
+        ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n <= 0){
+            streaming = false;      // stdin closed
+            break;
+        }
+        lineBuffer.append(buf, n);
 
-    if (stream == SND_PCM_STREAM_PLAYBACK){
-       snd_pcm_sw_params_set_start_threshold(*handle, sw_params, buffer - period);
-       snd_pcm_sw_params_set_avail_min(*handle, sw_params, period);
+        size_t newline;
+        while (streaming && (newline = lineBuffer.find('\n')) != std::string::npos){
+            std::string line = lineBuffer.substr(0, newline);
+            lineBuffer.erase(0, newline + 1);
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                streaming = false;
+            else if (engine)
+                engineControlLine(*engine, line);
+            else
+                sendControlLine(userData, line);
+        }
     }
 
-     err = snd_pcm_sw_params(*handle, sw_params);
-    if (err < 0) {
-        fprintf(stderr, "Error setting SW parameters: %s\n", snd_strerror(err));
-        return err;
+    if (threadStarted){
+        args.running = false;
+        pthread_join(thread, NULL);
+    }
+    stopMetricsExporter(exporter);
+
+    // Session summary
+    MetricsSnapshot snapshot;
+    metricsSnapshot(metrics, NULL, snapshot);
+    printf("Session stats:\n");
+    metricsPrint(stdout, snapshot);
+    printf("Period: %lu frames x %u, ~%.2f ms round trip\n",
+           pcm.period, pcm.periods, pcmLatencyMs(pcm));
+    if (audioPathAllocations() > 0)
+        printf("Warning: %lu heap allocations (%lu bytes) on the audio path\n",
+               audioPathAllocations(), audioPathAllocatedBytes());
+
+    if (engine){
+        printf("Engine: %u deadline misses, %u steals\n",
+               engine->stats.deadlineMisses.load(), engine->stats.steals.load());
+        engineReset(*engine);
+    }
+    else{
+        resetData(userData);
+        initData(userData, audioParams, effectChoice);
     }
-    snd_pcm_sw_params_free(sw_params);
 
-    return 0;
+    // reset effect flags so menu starts clean next time
+    effectChoice = EffectChoices();
+    stopDuplex(inHandle, outHandle, pcm);
+}
+
+
+// audio thread: read, process and write until stopped
+void* audioThread(void* arg){
+    AudioThreadArgs &args = *(AudioThreadArgs*)arg;
+    prefaultStack();
+
+    if (args.pcm->access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        mmapLoop(args);
+    else
+        rwLoop(args);
+
+    return NULL;
+}
+
+
+// process one block and record its timing
+static void processTimed(AudioThreadArgs &args, const void* in, void* out, unsigned long frames){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (args.engine)
+        engineProcess(*args.engine, in, out, frames);
+    else
+        processBlock(in, out, frames, args.ud);
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    metricsRecordBlock(*args.metrics, (uint32_t)elapsed.count(), frames);
 }
 
 
-// initialize data
-void initData(RtUserData &ud, AudioParams &audioParams, EffectChoices &effectChoice){
-    ud.params = &audioParams;
-    ud.effects = &effectChoice;
- 
-    ud.tremIncrement = 2.0 * audioParams.PI * audioParams.TREM_FREQ / (float)AudioParams::SAMPLE_RATE;
- 
-    ud.delaySize = max((float)1, AudioParams::DELAY_MS * (float)AudioParams::SAMPLE_RATE / 1000);
-    ud.delayBuffer.assign(ud.delaySize, 0.0f);
-    ud.delayIndex = 0;
- 
-    ud.reverbSize = AudioParams::SAMPLE_RATE;
-    ud.reverbBuffer.assign(ud.reverbSize, 0.0f);
-    float tapsMs[AudioParams::REVERB_TAPS] = {40, 50, 60, 80, 110};
-    float gains[AudioParams::REVERB_TAPS] = {0.6f, 0.5f, 0.4f, 0.3f, 0.25f};
-    for (int i = 0; i < AudioParams::REVERB_TAPS; i++){
-        ud.reverbDelay[i] = tapsMs[i] * AudioParams::SAMPLE_RATE / 1000;
-        ud.reverbGain[i] = gains[i];
-	ud.reverbIndex[i] = 0;
+// sample the round-trip latency every LATENCY_CHECK_BLOCKS blocks
+static void checkLatency(AudioThreadArgs &args, unsigned long &blockCount){
+    // Round-trip latency: frames waiting in capture + frames queued for playback
+    if ((blockCount++ & (LATENCY_CHECK_BLOCKS - 1)) == 0){
+        snd_pcm_sframes_t inDelay, outDelay;
+        if (snd_pcm_delay(args.inHandle, &inDelay) == 0 && snd_pcm_delay(args.outHandle, &outDelay) == 0)
+            metricsRecordLatency(*args.metrics, inDelay + outDelay);
     }
- 
-    ud.bitcrushCount = 0.0f;
-    ud.bitcrushSample = 0.0f;
- 
-    return;
 }
 
 
-// reset DSP data
-void resetData(RtUserData &ud){
-    std::fill(ud.delayBuffer.begin(), ud.delayBuffer.end(), 0.0f);
-    ud.delayIndex = 0;
+// recover from an XRUN. A linked pair is restarted together; if XRUNs keep
+// coming it is left stopped and the loop ends so the control thread can
+// double the period (reconfiguring allocates and prints, not for this thread)
+static void handleXrun(AudioThreadArgs &args, bool capture){
+    metricsRecordXrun(*args.metrics, capture);
+    PcmConfig &pcm = *args.pcm;
 
-    std::fill(ud.reverbBuffer.begin(), ud.reverbBuffer.end(), 0.0f);
-    for (int i = 0; i < AudioParams::REVERB_TAPS; i++)
-	ud.reverbIndex[i] = 0;   
+    if (!pcm.linked){
+        snd_pcm_t *handle = capture ? args.inHandle : args.outHandle;
+        snd_pcm_prepare(handle);
+        if (capture) snd_pcm_start(handle);
+        return;
+    }
 
-    ud.bitcrushCount = 0.0f;
-    ud.bitcrushSample = 0.0f;
+    stopDuplex(args.inHandle, args.outHandle, pcm);
 
-    if (ud.params)
-    	ud.params->tremPhase = 0.0f;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (now - args.xrunWindowStart > std::chrono::milliseconds(BACKOFF_WINDOW_MS)){
+        args.xrunWindowStart = now;
+        args.xrunsInWindow = 0;
+    }
+
+    if (++args.xrunsInWindow >= BACKOFF_XRUNS && pcm.period * 2 <= args.maxPeriod){
+        args.xrunsInWindow = 0;
+        args.backoff.store(true, std::memory_order_release);
+        return;
+    }
+
+    startDuplex(args.inHandle, args.outHandle, pcm);
 }
 
 
-void stream(RtUserData &userData, AudioParams &audioParams,
-            EffectChoices &effectChoice,
-            snd_pcm_t *inHandle, snd_pcm_t *outHandle,
-	    snd_pcm_uframes_t period){
-    // wait until user stops this session; then return to menu
-    printf("Streaming... Press ENTER to stop and return to menu\n");	
+// double the period of a stopped pair after repeated XRUNs (control thread)
+void backOff(AudioThreadArgs &args){
+    PcmConfig &pcm = *args.pcm;
+    snd_pcm_uframes_t oldPeriod = pcm.period;
+    pcm.period *= 2;
+    if (reconfigureDuplex(args.inHandle, args.outHandle, pcm) < 0 || pcm.period > args.maxPeriod){
+        pcm.period = oldPeriod;
+        reconfigureDuplex(args.inHandle, args.outHandle, pcm);
+    }
+    else
+        fprintf(stderr, "XRUNs at period %lu, backing off to %lu frames (~%.2f ms round trip)\n",
+                oldPeriod, pcm.period, pcmLatencyMs(pcm));
+}
 
-    bool streaming = true;
-    int writePtr = 0;
-    int readPtr = 0;
 
-    std::vector<SAMPLE> inputBlock(FRAMES_PER_BUFFER * audioParams.CHANNELS);
-    std::vector<SAMPLE> outputBlock(FRAMES_PER_BUFFER * audioParams.CHANNELS);
+// read/write loop: copy each period through inputBlock / outputBlock
+void rwLoop(AudioThreadArgs &args){
+    // the loop is paced by capture (with a timeout so a stop request is noticed)
+    PcmPoll capture;
+    pcmPollInit(capture, args.inHandle);
 
-    // polling
-    struct pollfd pfds[3];
-    int inCount = snd_pcm_poll_descriptors(inHandle, pfds, 1);
-    int outCount = snd_pcm_poll_descriptors(outHandle, pfds + 1, 1);
-    pfds[2].fd = STDIN_FILENO; pfds[2].events = POLLIN;
+    unsigned long blockCount = 0;
+    startDuplex(args.inHandle, args.outHandle, *args.pcm);
 
-    while (streaming){
-        int ret = poll(pfds, 3, -1);
-        if (ret < 0) continue;
+    while (args.running.load(std::memory_order_relaxed) && !args.backoff.load(std::memory_order_relaxed)){
+        if (!pcmPollWait(capture, 100)) continue;
 
-        // check for enter
-        if (pfds[2].revents & POLLIN) {
-            char c;
-            if (read(STDIN_FILENO, &c, 1) > 0 && c == '\n'){
-                streaming = false;
-                resetData(userData);
-                initData(userData, audioParams, effectChoice);
-                break;
-            }
-        }
-        
         snd_pcm_sframes_t framesRead =
-        snd_pcm_readi(inHandle, inputBlock.data(), period);
+        snd_pcm_readi(args.inHandle, args.inputBlock, std::min(args.pcm->period, args.maxPeriod));
         
         if (framesRead == -EAGAIN)
             continue;
 
         if (framesRead == -EPIPE) {     // xrun
-            fprintf(stderr, "XRUN (capture)\n");
-            snd_pcm_prepare(inHandle);
+            handleXrun(args, true);
             continue;
         }
 
@@ -232,28 +584,90 @@ void stream(RtUserData &userData, AudioParams &audioParams,
             continue;
 
         // *** process ***
-        processBlock(
-            inputBlock.data(),
-            outputBlock.data(),
-            framesRead,
-            &userData
-            );
+        processTimed(args, args.inputBlock, args.outputBlock, framesRead);
 
         // write to output
         snd_pcm_sframes_t framesWritten =
-            snd_pcm_writei(outHandle, outputBlock.data(), framesRead);
+            snd_pcm_writei(args.outHandle, args.outputBlock, framesRead);
 
         if (framesWritten == -EPIPE) {   // xrun
-            fprintf(stderr, "XRUN (playback)\n");
-            snd_pcm_prepare(outHandle);
+            handleXrun(args, false);
             continue;
         }
 
+        checkLatency(args, blockCount);
+    }
+}
+
+
+// address of the first frame of an interleaved mmap area
+static void* mmapFrames(const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t offset){
+    return (char*)areas[0].addr + (areas[0].first + offset * areas[0].step) / 8;
+}
+
+
+// mmap loop: processBlock reads from the capture ring buffer and writes
+// straight into the playback ring buffer (no copies)
+void mmapLoop(AudioThreadArgs &args){
+    PcmPoll capture, playback;
+    pcmPollInit(capture, args.inHandle);
+    pcmPollInit(playback, args.outHandle);
+
+    unsigned long blockCount = 0;
+
+    // capture does not start by itself when accessed through mmap
+    startDuplex(args.inHandle, args.outHandle, *args.pcm);
+
+    while (args.running.load(std::memory_order_relaxed) && !args.backoff.load(std::memory_order_relaxed)){
+        snd_pcm_sframes_t period = args.pcm->period;
+
+        snd_pcm_sframes_t inAvail = snd_pcm_avail_update(args.inHandle);
+        if (inAvail == -EPIPE){         // xrun
+            handleXrun(args, true);
+            continue;
+        }
+
+        snd_pcm_sframes_t outAvail = snd_pcm_avail_update(args.outHandle);
+        if (outAvail == -EPIPE){        // xrun
+            handleXrun(args, false);
+            continue;
+        }
+
+        // wait for a full period of input and room for it in the output,
+        // on whichever side is short
+        if (inAvail < period){
+            pcmPollWait(capture, 100);
+            continue;
+        }
+        if (outAvail < period){
+            pcmPollWait(playback, 100);
+            continue;
+        }
+
+        const snd_pcm_channel_area_t *inAreas, *outAreas;
+        snd_pcm_uframes_t inOffset, outOffset;
+        snd_pcm_uframes_t inFrames = period;
+        snd_pcm_uframes_t outFrames = period;
+
+        if (snd_pcm_mmap_begin(args.inHandle, &inAreas, &inOffset, &inFrames) < 0) continue;
+        if (snd_pcm_mmap_begin(args.outHandle, &outAreas, &outOffset, &outFrames) < 0){
+            snd_pcm_mmap_commit(args.inHandle, inOffset, 0);
+            continue;
+        }
+
+        // the areas may stop short at the end of the ring buffer
+        snd_pcm_uframes_t frames = inFrames < outFrames ? inFrames : outFrames;
+
+        // *** process ***
+        processTimed(args, mmapFrames(inAreas, inOffset), mmapFrames(outAreas, outOffset), frames);
+
+        snd_pcm_mmap_commit(args.inHandle, inOffset, frames);
+        snd_pcm_sframes_t committed = snd_pcm_mmap_commit(args.outHandle, outOffset, frames);
+        if (committed == -EPIPE){       // xrun
+            handleXrun(args, false);
+            continue;
+        }
+
+        checkLatency(args, blockCount);
     }
-    // reset effect flags so menu starts clean next time
-    effectChoice = EffectChoices();
-    snd_pcm_drop(inHandle);
-    snd_pcm_drop(outHandle);
-    snd_pcm_prepare(inHandle);
-    snd_pcm_prepare(outHandle);
 }
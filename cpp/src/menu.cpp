@@ -8,8 +8,26 @@
 */
 
 #include <iostream>
+#include <string>
 #include "../include/menu.h"
 
+// Append an effect to the chain order
+static void addToChain(EffectChoices &effectChoice, EffectType type){
+    if (effectChoice.chainLength < EffectChoices::MAX_CHAIN)
+        effectChoice.chain[effectChoice.chainLength++] = type;
+}
+
+// Chain choice function: selects every effect in a string, in order (e.g. "834")
+void chainSelect(const std::string &choices, EffectChoices &effectChoice, bool &validChoice, bool &exitFlag){
+    effectChoice = EffectChoices();
+    validChoice = !choices.empty();
+    for (size_t i = 0; i < choices.size() && validChoice && !exitFlag; i++){
+        bool valid = false;
+        choiceSelect(choices[i], effectChoice, valid, exitFlag);
+        validChoice = valid;
+    }
+}
+
 // Choice function
 void choiceSelect(char choice, EffectChoices &effectChoice, bool &validChoice, bool &exitFlag){
     switch (choice){
@@ -20,34 +38,72 @@ void choiceSelect(char choice, EffectChoices &effectChoice, bool &validChoice, b
 	    break;
         case '1':
             effectChoice.norm = true;
+            addToChain(effectChoice, EFFECT_NORM);
             validChoice = true;
             break;
         case '2':
             effectChoice.trem = true;
+            addToChain(effectChoice, EFFECT_TREM);
             validChoice = true;
             break;
         case '3':
             effectChoice.delay = true;
+            addToChain(effectChoice, EFFECT_DELAY);
             validChoice = true;
             break;
         case '4':
             effectChoice.reverb = true;
+            addToChain(effectChoice, EFFECT_REVERB);
             validChoice = true;
             break;
         case '5':
             effectChoice.bitcrush = true;
+            addToChain(effectChoice, EFFECT_BITCRUSH);
             validChoice = true;
             break;
         case '6':
             effectChoice.overdrive = true;
+            addToChain(effectChoice, EFFECT_OVERDRIVE);
             validChoice = true;
             break;
         case '7':
             effectChoice.distortion = true;
+            addToChain(effectChoice, EFFECT_DISTORTION);
             validChoice = true;
             break;
         case '8':
             effectChoice.fuzz = true;
+            addToChain(effectChoice, EFFECT_FUZZ);
+            validChoice = true;
+            break;
+        case '9':
+            effectChoice.cabinet = true;
+            addToChain(effectChoice, EFFECT_CABINET);
+            validChoice = true;
+            break;
+        case 'a':
+            effectChoice.phaser = true;
+            addToChain(effectChoice, EFFECT_PHASER);
+            validChoice = true;
+            break;
+        case 'b':
+            effectChoice.chorus = true;
+            addToChain(effectChoice, EFFECT_CHORUS);
+            validChoice = true;
+            break;
+        case 'c':
+            effectChoice.flanger = true;
+            addToChain(effectChoice, EFFECT_FLANGER);
+            validChoice = true;
+            break;
+        case 'd':
+            effectChoice.vibrato = true;
+            addToChain(effectChoice, EFFECT_VIBRATO);
+            validChoice = true;
+            break;
+        case 'e':
+            effectChoice.multitap = true;
+            addToChain(effectChoice, EFFECT_MULTITAP);
             validChoice = true;
             break;
         default:
@@ -59,7 +115,7 @@ void choiceSelect(char choice, EffectChoices &effectChoice, bool &validChoice, b
 bool menuFunction(EffectChoices &effectChoice){
     bool validChoice = false;
     bool exitFlag = false;
-    char userChoice;
+    std::string userChoice;
     std::cout << "*------ Audio Effects Program ------*\n" << "Effects Options:\n";
     std::cout << "(0) Exit Program" << std::endl; 
     std::cout << "(1) No Effects" << std::endl;
@@ -70,16 +126,23 @@ bool menuFunction(EffectChoices &effectChoice){
     std::cout << "(6) Overdrive" << std::endl;
     std::cout << "(7) Distortion" << std::endl;
     std::cout << "(8) Fuzz" << std::endl;
+    std::cout << "(9) Cabinet (impulse response)" << std::endl;
+    std::cout << "(a) Phaser" << std::endl;
+    std::cout << "(b) Chorus" << std::endl;
+    std::cout << "(c) Flanger" << std::endl;
+    std::cout << "(d) Vibrato" << std::endl;
+    std::cout << "(e) Multi-tap Delay" << std::endl;
 
-    std::cout << "Enter the integer value of the effect you would like to apply: ";
-    std::cin >> userChoice;
+    std::cout << "Enter the number (or letter) of the effect you would like to apply." << std::endl;
+    std::cout << "Chain effects by entering several in order (e.g. 834 = Fuzz -> Delay -> Reverb): ";
+    if (!(std::cin >> userChoice)) return false;
 
-    choiceSelect(userChoice, effectChoice, validChoice, exitFlag);
+    chainSelect(userChoice, effectChoice, validChoice, exitFlag);
    
     while (!validChoice){
         std::cout << "Enter a valid option: ";
-        std::cin >> userChoice; 
-        choiceSelect(userChoice, effectChoice, validChoice, exitFlag);
+        if (!(std::cin >> userChoice)) return false;
+        chainSelect(userChoice, effectChoice, validChoice, exitFlag);
     }
 
     if (exitFlag)
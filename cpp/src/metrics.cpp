@@ -0,0 +1,182 @@
+/*
+ * metrics.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of streaming metrics
+*/
+
+#include <chrono>
+#include <string>
+#include <cstdio>
+#include "../include/metrics.h"
+
+#define RELAXED std::memory_order_relaxed
+
+
+void metricsReset(Metrics &metrics, unsigned int rate){
+    for (int i = 0; i < METRICS_BINS; i++)
+        metrics.processHist[i].store(0, RELAXED);
+    metrics.blocks.store(0, RELAXED);
+    metrics.processMaxNs.store(0, RELAXED);
+    metrics.loadMaxPermille.store(0, RELAXED);
+    metrics.processNsTotal.store(0, RELAXED);
+    metrics.periodNsTotal.store(0, RELAXED);
+    metrics.xrunCapture.store(0, RELAXED);
+    metrics.xrunPlayback.store(0, RELAXED);
+    metrics.latencyFrames.store(-1, RELAXED);
+    metrics.sampleRate.store(rate, RELAXED);
+}
+
+
+// Histogram bin of a duration: octave from the leading bit, sub-bin from the next two
+static int histBin(uint32_t ns){
+    if (ns < (1u << METRICS_MIN_OCTAVE)) return 0;
+    int octave = 31 - __builtin_clz(ns);
+    int sub = (ns >> (octave - 2)) & (METRICS_BINS_PER_OCTAVE - 1);
+    int bin = (octave - METRICS_MIN_OCTAVE) * METRICS_BINS_PER_OCTAVE + sub;
+    return bin < METRICS_BINS ? bin : METRICS_BINS - 1;
+}
+
+// Upper edge of a bin in ns
+static double binUpperNs(int bin){
+    int octave = bin / METRICS_BINS_PER_OCTAVE + METRICS_MIN_OCTAVE;
+    int sub = bin % METRICS_BINS_PER_OCTAVE;
+    return (double)(1ull << octave) * (1.0 + (sub + 1) / (double)METRICS_BINS_PER_OCTAVE);
+}
+
+
+// ---------------------------------------------------------------------------
+// Audio thread (single writer, so load + store is enough)
+// ---------------------------------------------------------------------------
+
+void metricsRecordBlock(Metrics &metrics, uint32_t processNs, unsigned long frames){
+    uint32_t rate = metrics.sampleRate.load(RELAXED);
+    uint64_t periodNs = rate ? (uint64_t)frames * 1000000000ull / rate : 0;
+
+    std::atomic<uint32_t> &bin = metrics.processHist[histBin(processNs)];
+    bin.store(bin.load(RELAXED) + 1, RELAXED);
+    metrics.blocks.store(metrics.blocks.load(RELAXED) + 1, RELAXED);
+    metrics.processNsTotal.store(metrics.processNsTotal.load(RELAXED) + processNs, RELAXED);
+    metrics.periodNsTotal.store(metrics.periodNsTotal.load(RELAXED) + periodNs, RELAXED);
+
+    if (processNs > metrics.processMaxNs.load(RELAXED))
+        metrics.processMaxNs.store(processNs, RELAXED);
+
+    if (periodNs > 0){
+        uint32_t load = (uint32_t)((uint64_t)processNs * 1000 / periodNs);
+        if (load > metrics.loadMaxPermille.load(RELAXED))
+            metrics.loadMaxPermille.store(load, RELAXED);
+    }
+}
+
+void metricsRecordXrun(Metrics &metrics, bool capture){
+    std::atomic<uint32_t> &counter = capture ? metrics.xrunCapture : metrics.xrunPlayback;
+    counter.store(counter.load(RELAXED) + 1, RELAXED);
+}
+
+void metricsRecordLatency(Metrics &metrics, long frames){
+    metrics.latencyFrames.store((int32_t)frames, RELAXED);
+}
+
+
+// ---------------------------------------------------------------------------
+// Readers
+// ---------------------------------------------------------------------------
+
+void metricsSnapshot(const Metrics &metrics, const MetricsSnapshot* previous, MetricsSnapshot &snapshot){
+    uint32_t hist[METRICS_BINS];
+    uint32_t total = 0;
+    for (int i = 0; i < METRICS_BINS; i++){
+        hist[i] = metrics.processHist[i].load(RELAXED);
+        total += hist[i];
+    }
+
+    // Percentiles from the histogram (upper edge of the bin holding the rank)
+    double p50 = 0.0, p99 = 0.0;
+    uint32_t seen = 0;
+    for (int i = 0; i < METRICS_BINS && total > 0; i++){
+        seen += hist[i];
+        if (p50 == 0.0 && seen * 2 >= total)   p50 = binUpperNs(i);
+        if (p99 == 0.0 && seen * 100 >= total * 99ull){ p99 = binUpperNs(i); break; }
+    }
+
+    snapshot.blocks         = metrics.blocks.load(RELAXED);
+    snapshot.processP50Us   = p50 / 1000.0;
+    snapshot.processP99Us   = p99 / 1000.0;
+    snapshot.processMaxUs   = metrics.processMaxNs.load(RELAXED) / 1000.0;
+
+    // A bin edge can overshoot the largest value actually seen
+    if (snapshot.processP50Us > snapshot.processMaxUs) snapshot.processP50Us = snapshot.processMaxUs;
+    if (snapshot.processP99Us > snapshot.processMaxUs) snapshot.processP99Us = snapshot.processMaxUs;
+    snapshot.loadMax        = metrics.loadMaxPermille.load(RELAXED) / 1000.0;
+    snapshot.xrunCapture    = metrics.xrunCapture.load(RELAXED);
+    snapshot.xrunPlayback   = metrics.xrunPlayback.load(RELAXED);
+    snapshot.latencyFrames  = metrics.latencyFrames.load(RELAXED);
+    snapshot.processNsTotal = metrics.processNsTotal.load(RELAXED);
+    snapshot.periodNsTotal  = metrics.periodNsTotal.load(RELAXED);
+
+    uint32_t rate = metrics.sampleRate.load(RELAXED);
+    snapshot.latencyMs = (snapshot.latencyFrames >= 0 && rate) ? snapshot.latencyFrames * 1000.0 / rate : -1.0;
+
+    uint64_t processNs = snapshot.processNsTotal - (previous ? previous->processNsTotal : 0);
+    uint64_t periodNs  = snapshot.periodNsTotal  - (previous ? previous->periodNsTotal : 0);
+    snapshot.loadAvg = periodNs ? (double)processNs / periodNs : 0.0;
+}
+
+void metricsPrint(FILE* fp, const MetricsSnapshot &snapshot){
+    fprintf(fp, "blocks %u\n", snapshot.blocks);
+    fprintf(fp, "process_p50_us %.1f\n", snapshot.processP50Us);
+    fprintf(fp, "process_p99_us %.1f\n", snapshot.processP99Us);
+    fprintf(fp, "process_max_us %.1f\n", snapshot.processMaxUs);
+    fprintf(fp, "load_avg %.4f\n", snapshot.loadAvg);
+    fprintf(fp, "load_max %.4f\n", snapshot.loadMax);
+    fprintf(fp, "xrun_capture %u\n", snapshot.xrunCapture);
+    fprintf(fp, "xrun_playback %u\n", snapshot.xrunPlayback);
+    fprintf(fp, "latency_frames %d\n", snapshot.latencyFrames);
+    fprintf(fp, "latency_ms %.2f\n", snapshot.latencyMs);
+}
+
+
+// Exporter thread: write a snapshot every interval
+static void exporterLoop(MetricsExporter* exporter){
+    std::string tmpPath = std::string(exporter->path) + ".tmp";
+    MetricsSnapshot previous, snapshot;
+    metricsSnapshot(*exporter->metrics, NULL, previous);
+
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    while (exporter->running.load()){
+        next += std::chrono::milliseconds(exporter->intervalMs);
+
+        // Sleep in short steps so stopping is quick
+        while (exporter->running.load() && std::chrono::steady_clock::now() < next)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+        metricsSnapshot(*exporter->metrics, &previous, snapshot);
+        previous = snapshot;
+
+        FILE* fp = fopen(tmpPath.c_str(), "w");
+        if (!fp) continue;
+        metricsPrint(fp, snapshot);
+        fclose(fp);
+        rename(tmpPath.c_str(), exporter->path);
+    }
+}
+
+void startMetricsExporter(MetricsExporter &exporter, const Metrics &metrics,
+                          const char* path, int intervalMs){
+    if (!path || intervalMs <= 0) return;
+    exporter.metrics = &metrics;
+    exporter.path = path;
+    exporter.intervalMs = intervalMs;
+    exporter.running = true;
+    exporter.thread = std::thread(exporterLoop, &exporter);
+}
+
+void stopMetricsExporter(MetricsExporter &exporter){
+    if (!exporter.running.load()) return;
+    exporter.running = false;
+    exporter.thread.join();
+}
@@ -0,0 +1,338 @@
+/*
+ * multitap.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the multi-tap delay
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include "../include/multitap.h"
+
+#define MULTITAP_PI           3.14159265358979323846
+#define MULTITAP_MAX_FEEDBACK 0.95f     // bound on the summed feedback (keeps the loop stable)
+#define MULTITAP_MAX_GAIN     2.0f
+#define MULTITAP_MAX_DAMPING  0.99f
+#define MULTITAP_MAX_NUMERATOR   64.0f
+#define MULTITAP_MAX_DENOMINATOR 128.0f
+
+
+// Parse one number of a tap; empty fields keep the default
+static bool parseNumber(const std::string &field, float min, float max, float &value){
+    if (field.empty()) return true;
+
+    char* end = NULL;
+    float number = strtof(field.c_str(), &end);
+    if (*end != '\0' || !(number >= min && number <= max)) return false;
+    value = number;
+    return true;
+}
+
+
+// Beats of a note division (a whole note is four beats)
+static float divisionBeats(float numerator, float denominator, int suffix){
+    float scale = suffix == '.' ? 1.5f : suffix == 't' ? 2.0f / 3.0f : 1.0f;
+    return 4.0f * numerator / denominator * scale;
+}
+
+// Parse a tap time: milliseconds, or n/d with an optional '.' or 't'
+static bool parseTime(std::string field, TapSetting &tap){
+    size_t slash = field.find('/');
+    if (slash == std::string::npos){
+        tap.beats = 0.0f;
+        return parseNumber(field, 1.0f, MULTITAP_MAX_MS, tap.ms);
+    }
+
+    int suffix = 0;
+    if (!field.empty() && (field[field.size() - 1] == '.' || field[field.size() - 1] == 't')){
+        suffix = field[field.size() - 1];
+        field.erase(field.size() - 1);
+    }
+
+    float numerator = 0.0f, denominator = 0.0f;
+    if (slash == 0 || slash + 1 >= field.size()) return false;
+    if (!parseNumber(field.substr(0, slash), 1.0f, MULTITAP_MAX_NUMERATOR, numerator)) return false;
+    if (!parseNumber(field.substr(slash + 1), 1.0f, MULTITAP_MAX_DENOMINATOR, denominator)) return false;
+
+    tap.beats = divisionBeats(numerator, denominator, suffix);
+    tap.ms = 0.0f;
+    tap.numerator = numerator;
+    tap.denominator = denominator;
+    tap.suffix = suffix;
+    return true;
+}
+
+
+int multitapParse(const std::string &spec, TapPattern &pattern){
+    TapPattern parsed;
+    parsed.count = 0;
+
+    std::istringstream items(spec);
+    std::string item;
+    float feedback = 0.0f;
+
+    while (std::getline(items, item, ',')){
+        if (parsed.count >= MULTITAP_MAX_TAPS){
+            fprintf(stderr, "Error: at most %d taps\n", MULTITAP_MAX_TAPS);
+            return -1;
+        }
+
+        TapSetting tap = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0};
+        std::istringstream fields(item);
+        std::string field[5];
+        int count = 0;
+        while (count < 5 && std::getline(fields, field[count], ':')) count++;
+
+        std::string extra;
+        if (count == 0 || field[0].empty() || std::getline(fields, extra)
+            || !parseTime(field[0], tap)
+            || !parseNumber(field[1], 0.0f, MULTITAP_MAX_GAIN, tap.gain)
+            || !parseNumber(field[2], -1.0f, 1.0f, tap.pan)
+            || !parseNumber(field[3], -MULTITAP_MAX_FEEDBACK, MULTITAP_MAX_FEEDBACK, tap.feedback)
+            || !parseNumber(field[4], 0.0f, MULTITAP_MAX_DAMPING, tap.damping)){
+            fprintf(stderr, "Error: invalid tap %s (time[:gain[:pan[:feedback[:damping]]]],"
+                            " time in ms or a division like 1/8, 1/8. or 1/8t)\n", item.c_str());
+            return -1;
+        }
+
+        feedback += fabsf(tap.feedback);
+        parsed.taps[parsed.count++] = tap;
+    }
+
+    if (parsed.count == 0){
+        fprintf(stderr, "Error: no taps in %s\n", spec.c_str());
+        return -1;
+    }
+    if (feedback > MULTITAP_MAX_FEEDBACK){
+        fprintf(stderr, "Error: tap feedback adds up to %.2f (at most %.2f)\n", feedback, MULTITAP_MAX_FEEDBACK);
+        return -1;
+    }
+
+    pattern = parsed;
+    return 0;
+}
+
+
+// Whether a value lies in [min, max] (false for NaN)
+static bool inRange(float value, float min, float max){
+    return value >= min && value <= max;
+}
+
+bool multitapValid(const TapPattern &pattern){
+    if (pattern.count < 1 || pattern.count > MULTITAP_MAX_TAPS) return false;
+
+    float feedback = 0.0f;
+    for (int t = 0; t < pattern.count; t++){
+        const TapSetting &tap = pattern.taps[t];
+        if (tap.beats == 0.0f){
+            if (!inRange(tap.ms, 1.0f, MULTITAP_MAX_MS)) return false;
+        }
+        else if (!inRange(tap.numerator, 1.0f, MULTITAP_MAX_NUMERATOR)
+                 || !inRange(tap.denominator, 1.0f, MULTITAP_MAX_DENOMINATOR)
+                 || (tap.suffix != 0 && tap.suffix != '.' && tap.suffix != 't')
+                 || tap.beats != divisionBeats(tap.numerator, tap.denominator, tap.suffix))
+            return false;
+
+        if (!inRange(tap.gain, 0.0f, MULTITAP_MAX_GAIN) || !inRange(tap.pan, -1.0f, 1.0f)
+            || !inRange(tap.feedback, -MULTITAP_MAX_FEEDBACK, MULTITAP_MAX_FEEDBACK)
+            || !inRange(tap.damping, 0.0f, MULTITAP_MAX_DAMPING))
+            return false;
+        feedback += fabsf(tap.feedback);
+    }
+    return feedback <= MULTITAP_MAX_FEEDBACK;
+}
+
+
+// Work out the distances and gains of a pattern at a tempo
+static void buildVoice(MultiTapVoice &voice, const TapPattern &pattern, float bpm, int sampleRate){
+    const float maxDistance = MULTITAP_MAX_MS * (float)sampleRate / 1000;
+
+    voice.count = pattern.count;
+    voice.shortest = MULTITAP_CHUNK;
+    for (int k = 0; k < pattern.count; k++){
+        const TapSetting &tap = pattern.taps[k];
+        float ms = tap.beats > 0.0f ? tap.beats * 60000.0f / bpm : tap.ms;
+        float distance = roundf(ms * (float)sampleRate / 1000);
+        if (distance < 1.0f) distance = 1.0f;
+        if (distance > maxDistance) distance = maxDistance;
+
+        voice.distance[k] = (unsigned)distance;
+        voice.shortest = std::min(voice.shortest, voice.distance[k]);
+
+        // Equal power pan
+        double angle = (tap.pan + 1.0) * MULTITAP_PI / 4;
+        voice.gain[0][k] = tap.gain * (float)cos(angle);
+        voice.gain[1][k] = tap.gain * (float)sin(angle);
+        voice.monoGain[k] = tap.gain;
+        voice.feedback[k] = tap.feedback;
+        voice.coeff[k] = 1.0f - tap.damping;
+    }
+
+    // Unused taps are still summed: silence them
+    for (int k = pattern.count; k < MULTITAP_MAX_TAPS; k++){
+        voice.gain[0][k] = voice.gain[1][k] = voice.monoGain[k] = 0.0f;
+        voice.feedback[k] = 0.0f;
+        voice.coeff[k] = 0.0f;
+    }
+
+    std::fill(voice.lowpass.begin(), voice.lowpass.end(), 0.0f);
+}
+
+
+void multitapInit(MultiTapDelay &delay, const TapPattern &pattern, float bpm,
+                  int sampleRate, int channels){
+    delay.lines.resize(channels);
+    for (int ch = 0; ch < channels; ch++)
+        delayInit(delay.lines[ch], (unsigned)(MULTITAP_MAX_MS * (float)sampleRate / 1000));
+
+    for (int v = 0; v < 2; v++)
+        delay.voices[v].lowpass.assign(channels * MULTITAP_MAX_TAPS, 0.0f);
+
+    // Buffers of unused taps are read too (with zero gains): keep them finite
+    for (int k = 0; k < MULTITAP_MAX_TAPS; k++)
+        std::fill(delay.taps[k], delay.taps[k] + MULTITAP_CHUNK, 0.0f);
+
+    delay.pattern = pattern;
+    delay.bpm = bpm;
+    delay.sampleRate = sampleRate;
+    delay.fadeFrames = std::max(1, MULTITAP_FADE_MS * sampleRate / 1000);
+    multitapReset(delay);
+}
+
+
+void multitapReset(MultiTapDelay &delay){
+    for (size_t ch = 0; ch < delay.lines.size(); ch++)
+        delayReset(delay.lines[ch]);
+
+    delay.current = 0;
+    buildVoice(delay.voices[0], delay.pattern, delay.bpm, delay.sampleRate);
+    delay.fadeRemaining = 0;
+    delay.pending = false;
+}
+
+
+void multitapSetPattern(MultiTapDelay &delay, const TapPattern &pattern){
+    delay.pattern = pattern;
+    delay.pending = true;
+}
+
+
+void multitapSetTempo(MultiTapDelay &delay, float bpm){
+    if (bpm == delay.bpm) return;
+    delay.bpm = bpm;
+    delay.pending = true;
+}
+
+
+// Add one voice's taps over a chunk into wet / feedback, weighted by
+// weight + i * step (the crossfade)
+static void mixVoice(MultiTapDelay &delay, MultiTapVoice &voice, int ch, int channels,
+                     unsigned long frames, float weight, float step){
+    const DelayLine &line = delay.lines[ch];
+    const int count = voice.count;
+    const float* gain = channels == 1 ? voice.monoGain : voice.gain[ch & 1];
+    float* lowpass = voice.lowpass.data() + ch * MULTITAP_MAX_TAPS;
+
+    for (int k = 0; k < count; k++)
+        delayCopy(line, voice.distance[k], delay.taps[k], frames);
+
+    // All MULTITAP_MAX_TAPS side by side (unused ones have zero gains), so
+    // the loop unrolls, the filter states stay in registers and the damping
+    // filters overlap instead of each waiting on its own previous output
+    // (locals, so the stores below cannot alias them)
+    float state[MULTITAP_MAX_TAPS], g[MULTITAP_MAX_TAPS], c[MULTITAP_MAX_TAPS], f[MULTITAP_MAX_TAPS];
+    for (int k = 0; k < MULTITAP_MAX_TAPS; k++){
+        state[k] = lowpass[k];
+        g[k] = gain[k];
+        c[k] = voice.coeff[k];
+        f[k] = voice.feedback[k];
+    }
+
+    float* wetOut = delay.wet;
+    float* feedbackOut = delay.feedback;
+    for (unsigned long i = 0; i < frames; i++){
+        float wet = 0.0f, feedback = 0.0f;
+        for (int k = 0; k < MULTITAP_MAX_TAPS; k++){
+            float tap = delay.taps[k][i];
+            wet += g[k] * tap;
+            state[k] += c[k] * (tap - state[k]);
+            feedback += f[k] * state[k];
+        }
+
+        float w = weight + step * i;
+        wetOut[i] += w * wet;
+        feedbackOut[i] += w * feedback;
+    }
+
+    for (int k = 0; k < MULTITAP_MAX_TAPS; k++) lowpass[k] = state[k];
+}
+
+
+void multitapProcess(MultiTapDelay &delay, float* const* block, int channels,
+                     unsigned long frames, float mix){
+
+    // Start the latest pattern / tempo once no fade is running
+    if (delay.pending && delay.fadeRemaining == 0){
+        buildVoice(delay.voices[1 - delay.current], delay.pattern, delay.bpm, delay.sampleRate);
+        delay.fadeRemaining = delay.fadeFrames;
+        delay.pending = false;
+    }
+
+    const float fadeStep = 1.0f / delay.fadeFrames;
+    const int startRemaining = delay.fadeRemaining;
+    int remaining = startRemaining;
+    int current = delay.current;
+
+    for (int ch = 0; ch < channels; ch++){
+        DelayLine &line = delay.lines[ch];
+        float* x = block[ch];
+        remaining = startRemaining;
+        current = delay.current;
+
+        unsigned long done = 0;
+        while (done < frames){
+            MultiTapVoice &voice = delay.voices[current];
+            MultiTapVoice &next = delay.voices[1 - current];
+
+            // Chunk: no longer than any tap, and ending where a fade ends
+            unsigned long n = std::min<unsigned long>(frames - done, voice.shortest);
+            if (remaining > 0){
+                n = std::min<unsigned long>(n, next.shortest);
+                n = std::min<unsigned long>(n, remaining);
+            }
+
+            std::fill(delay.wet, delay.wet + n, 0.0f);
+            std::fill(delay.feedback, delay.feedback + n, 0.0f);
+
+            if (remaining > 0){
+                float faded = (float)(delay.fadeFrames - remaining + 1) * fadeStep;
+                mixVoice(delay, voice, ch, channels, n, 1.0f - faded, -fadeStep);
+                mixVoice(delay, next, ch, channels, n, faded, fadeStep);
+                remaining -= n;
+                if (remaining == 0) current = 1 - current;
+            }
+            else
+                mixVoice(delay, voice, ch, channels, n, 1.0f, 0.0f);
+
+            // Write input plus feedback, then mix
+            float* in = x + done;
+            for (unsigned long i = 0; i < n; i++)
+                delay.feedback[i] += in[i];
+            delayWriteBlock(line, delay.feedback, n);
+
+            for (unsigned long i = 0; i < n; i++)
+                in[i] = (1.0f - mix) * in[i] + mix * delay.wet[i];
+
+            done += n;
+        }
+    }
+
+    delay.current = current;
+    delay.fadeRemaining = remaining;
+}
@@ -0,0 +1,143 @@
+/*
+ * oversample.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the oversampler
+*/
+
+#include <cmath>
+#include <cstring>
+#include "../include/oversample.h"
+
+#define OVERSAMPLE_PI 3.14159265358979323846
+#define KAISER_BETA   7.86          // about 80 dB stopband
+
+// Half-band length of each stage (4K - 1 taps, K taps per side in the even phase).
+// Stage 0 runs between the base rate and 2x and has the narrow transition band.
+static const int STAGE_TAPS[OVERSAMPLE_MAX_STAGES] = {51, 23, 15};
+
+
+// Zeroth order modified Bessel function (Kaiser window)
+static double besselI0(double x){
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++){
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+
+void oversamplerInit(Oversampler &os){
+    for (int s = 0; s < OVERSAMPLE_MAX_STAGES; s++){
+        const int taps = STAGE_TAPS[s];
+        const int centre = (taps - 1) / 2;
+        const int branchTaps = (taps + 1) / 2;
+
+        // Kaiser windowed sinc at a quarter of the rate; only the even taps are kept
+        float coeffs[MAX_FIR_TAPS];
+        double sum = 0.0;
+        for (int i = 0; i < branchTaps; i++){
+            double t = 2 * i - centre;
+            double r = t / centre;
+            double sinc = sin(0.5 * OVERSAMPLE_PI * t) / (OVERSAMPLE_PI * t);
+            double window = besselI0(KAISER_BETA * sqrt(1.0 - r * r)) / besselI0(KAISER_BETA);
+            coeffs[i] = (float)(sinc * window);
+            sum += coeffs[i];
+        }
+
+        // The even taps sum to 1/2 for unity gain; the branch is stored doubled
+        for (int i = 0; i < branchTaps; i++)
+            coeffs[i] = (float)(coeffs[i] / sum);
+        firSetCoefficients(os.branch[s], coeffs, branchTaps);
+    }
+}
+
+
+void oversampleReset(const Oversampler &os, OversampleState &state, int factor){
+    state = OversampleState();
+
+    int stages = 0;
+    while (stages < OVERSAMPLE_MAX_STAGES && (2 << stages) <= factor) stages++;
+    state.stages = stages;
+    state.factor = 1 << stages;
+
+    // Each stage delays by its half-band centre on the way up and again on
+    // the way down, at its own rate. Count in top rate samples and pad up to
+    // whole base frames.
+    int total = 0;
+    for (int s = 0; s < stages; s++){
+        const int centre = os.branch[s].taps - 1;
+        total += 2 * centre << (stages - 1 - s);
+    }
+    state.pad = (state.factor - total % state.factor) % state.factor;
+    state.latency = (total + state.pad) / state.factor;
+}
+
+
+// out[i] = in[i - delay] (in and out may be the same buffer)
+static void delayRun(OversampleDelay &d, int delay, const float* in, float* out, int frames){
+    int index = d.index;
+    for (int i = 0; i < frames; i++){
+        d.line[index] = in[i];
+        out[i] = d.line[(index - delay) & (OVERSAMPLE_DELAY - 1)];
+        index = (index + 1) & (OVERSAMPLE_DELAY - 1);
+    }
+    d.index = index;
+}
+
+
+float* oversampleUp(Oversampler &os, OversampleState &state, float* x, int frames){
+    float* in = x;
+    int count = frames;
+
+    for (int s = 0; s < state.stages; s++){
+        const FirCoefficients &branch = os.branch[s];
+        float* out = os.stage[s];
+
+        // Even outputs are the FIR branch, odd outputs the delayed input
+        firProcess(branch, state.upHistory[s], in, os.even, count);
+        delayRun(state.upDelay[s], branch.taps / 2 - 1, in, os.odd, count);
+        for (int i = 0; i < count; i++){
+            out[2 * i] = os.even[i];
+            out[2 * i + 1] = os.odd[i];
+        }
+
+        in = out;
+        count *= 2;
+    }
+
+    if (state.pad > 0)
+        delayRun(state.padDelay, state.pad, in, in, count);
+    return in;
+}
+
+
+void oversampleDown(Oversampler &os, OversampleState &state, float* x, int frames){
+    for (int s = state.stages - 1; s >= 0; s--){
+        const FirCoefficients &branch = os.branch[s];
+        const int count = frames << s;
+        const float* in = os.stage[s];
+        float* out = s > 0 ? os.stage[s - 1] : x;
+
+        for (int i = 0; i < count; i++){
+            os.even[i] = in[2 * i];
+            os.odd[i] = in[2 * i + 1];
+        }
+
+        // Even phase through the FIR branch plus the centre tap on the odd phase
+        firProcess(branch, state.downHistory[s], os.even, out, count);
+        delayRun(state.downDelay[s], branch.taps / 2, os.odd, os.odd, count);
+        for (int i = 0; i < count; i++)
+            out[i] = 0.5f * (out[i] + os.odd[i]);
+    }
+}
+
+
+void oversampleAlign(OversampleState &state, float* x, unsigned long frames){
+    if (state.latency == 0) return;
+    delayRun(state.dryDelay, state.latency, x, x, (int)frames);
+}
@@ -0,0 +1,317 @@
+/*
+ * pcm.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of ALSA PCM helpers
+*/
+
+#include <cstdio>
+#include <cerrno>
+#include <chrono>
+#include <vector>
+#include <poll.h>
+#include "../include/pcm.h"
+
+const bool DEBUG = 0;
+
+#define SILENCE_BYTES 4096
+
+static const char* FORMAT_NAMES[NUM_FORMATS] = {"s16", "s24", "s32", "float"};
+
+static const snd_pcm_format_t ALSA_FORMATS[NUM_FORMATS] = {
+    SND_PCM_FORMAT_S16_LE,
+    SND_PCM_FORMAT_S24_LE,
+    SND_PCM_FORMAT_S32_LE,
+    SND_PCM_FORMAT_FLOAT_LE
+};
+
+// Tried in this order when any format will do (widest integer first)
+static const SampleFormat FORMAT_PREFERENCE[NUM_FORMATS] = {
+    FORMAT_S32, FORMAT_S24, FORMAT_S16, FORMAT_FLOAT
+};
+
+
+const char* sampleFormatName(SampleFormat format){
+    return format < NUM_FORMATS ? FORMAT_NAMES[format] : "?";
+}
+
+
+SampleFormat sampleFormatByName(const std::string &name){
+    for (int i = 0; i < NUM_FORMATS; i++)
+        if (name == FORMAT_NAMES[i]) return (SampleFormat)i;
+    return NUM_FORMATS;
+}
+
+
+// read/write through whichever access the PCM was opened with
+static snd_pcm_sframes_t pcmRead(snd_pcm_t* handle, void* buffer, snd_pcm_uframes_t frames,
+                                 const PcmConfig &config){
+    if (config.access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        return snd_pcm_mmap_readi(handle, buffer, frames);
+    return snd_pcm_readi(handle, buffer, frames);
+}
+
+static snd_pcm_sframes_t pcmWrite(snd_pcm_t* handle, const void* buffer, snd_pcm_uframes_t frames,
+                                  const PcmConfig &config){
+    if (config.access == SND_PCM_ACCESS_MMAP_INTERLEAVED)
+        return snd_pcm_mmap_writei(handle, buffer, frames);
+    return snd_pcm_writei(handle, buffer, frames);
+}
+
+
+int setupPCM(const char* device, snd_pcm_t** handle, snd_pcm_stream_t stream,
+	     PcmConfig &config){
+
+    int err = snd_pcm_open(handle, device, stream, 0);
+    if (err < 0) {
+        fprintf(stderr, "Error opening PCM device: %s\n", snd_strerror(err));
+        return err;
+    }
+
+    err = configurePCM(*handle, stream, config);
+    if (err < 0) {
+        snd_pcm_close(*handle);
+        return err;
+    }
+    return 0;
+}
+
+
+int configurePCM(snd_pcm_t* handle, snd_pcm_stream_t stream, PcmConfig &config){
+    snd_pcm_uframes_t period = config.period;
+    snd_pcm_uframes_t buffer = config.period * config.periods;
+
+    snd_pcm_hw_params_t* params;
+
+    snd_pcm_hw_params_alloca(&params);
+    snd_pcm_hw_params_any(handle, params);
+    int err = snd_pcm_hw_params_set_access(handle, params, config.access);
+    if (err < 0) {
+        fprintf(stderr, "Error setting PCM access: %s\n", snd_strerror(err));
+        return err;
+    }
+
+    // run at the device's own rate rather than resampling in the plug layer
+    snd_pcm_hw_params_set_rate_resample(handle, params, 0);
+
+    SampleFormat format = config.format;
+    if (config.anyFormat){
+        for (int i = 0; i < NUM_FORMATS; i++)
+            if (snd_pcm_hw_params_test_format(handle, params, ALSA_FORMATS[FORMAT_PREFERENCE[i]]) == 0){
+                format = FORMAT_PREFERENCE[i];
+                break;
+            }
+    }
+    err = snd_pcm_hw_params_set_format(handle, params, ALSA_FORMATS[format]);
+    if (err < 0) {
+        fprintf(stderr, "Error setting PCM format %s: %s\n", sampleFormatName(format), snd_strerror(err));
+        return err;
+    }
+
+    unsigned int channels = config.channels;
+    snd_pcm_hw_params_set_channels_near(handle, params, &channels);
+    if (channels > config.maxChannels) {
+        fprintf(stderr, "Error: device needs %u channels, at most %u are supported\n",
+                channels, config.maxChannels);
+        return -EINVAL;
+    }
+
+    unsigned int rate = config.rate;
+    snd_pcm_hw_params_set_rate_near(handle, params, &rate, 0);
+    snd_pcm_hw_params_set_period_size_near(handle, params, &period, 0);
+    snd_pcm_hw_params_set_buffer_size_near(handle, params, &buffer);
+    err = snd_pcm_hw_params(handle, params);
+    if (err < 0) {
+        fprintf(stderr, "Error setting input PCM parameters: %s\n", snd_strerror(err));
+        return err;
+    }
+    snd_pcm_hw_params_get_period_size(params, &period, 0);
+    snd_pcm_hw_params_get_buffer_size(params, &buffer);
+    snd_pcm_prepare(handle);
+
+    if (DEBUG){
+        printf("Period: %lu, Buffer: %lu\n", period, buffer);
+    }
+    config.period = period;
+    config.rate = rate;
+    config.channels = channels;
+    config.format = format;
+
+    // set sw params
+    snd_pcm_sw_params_t* sw_params;
+    snd_pcm_sw_params_malloc(&sw_params);
+    snd_pcm_sw_params_current(handle, sw_params);
+
+
+    if (stream == SND_PCM_STREAM_PLAYBACK){
+       // a linked pair is started explicitly, so playback must never start itself
+       snd_pcm_uframes_t threshold = config.linked ? buffer * 2 : buffer - period;
+       snd_pcm_sw_params_set_start_threshold(handle, sw_params, threshold);
+       snd_pcm_sw_params_set_avail_min(handle, sw_params, period);
+    }
+
+     err = snd_pcm_sw_params(handle, sw_params);
+    snd_pcm_sw_params_free(sw_params);
+    if (err < 0) {
+        fprintf(stderr, "Error setting SW parameters: %s\n", snd_strerror(err));
+        return err;
+    }
+
+    return 0;
+}
+
+
+int openDuplex(const char* device, snd_pcm_t** inHandle, snd_pcm_t** outHandle,
+               PcmConfig &config){
+    int err = setupPCM(device, inHandle, SND_PCM_STREAM_CAPTURE, config);
+    if (err < 0) return err;
+
+    // playback has to run in exactly the format capture negotiated
+    config.anyFormat = false;
+    PcmConfig captureConfig = config;
+
+    err = setupPCM(device, outHandle, SND_PCM_STREAM_PLAYBACK, config);
+    if (err == 0 && (config.rate != captureConfig.rate || config.channels != captureConfig.channels)){
+        fprintf(stderr, "Error: playback runs at %u Hz / %u channels, capture at %u Hz / %u channels\n",
+                config.rate, config.channels, captureConfig.rate, captureConfig.channels);
+        snd_pcm_close(*outHandle);
+        err = -EINVAL;
+    }
+    if (err < 0){
+        snd_pcm_close(*inHandle);
+        return err;
+    }
+
+    if (config.linked && snd_pcm_link(*inHandle, *outHandle) < 0){
+        fprintf(stderr, "Warning: cannot link capture and playback, starting them separately\n");
+        config.linked = false;
+        // playback needs its normal start threshold again
+        configurePCM(*outHandle, SND_PCM_STREAM_PLAYBACK, config);
+    }
+    return 0;
+}
+
+
+int reconfigureDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, PcmConfig &config){
+    if (config.linked) snd_pcm_unlink(inHandle);
+
+    int err = configurePCM(inHandle, SND_PCM_STREAM_CAPTURE, config);
+    // playback follows whatever period capture ended up with
+    if (err == 0) err = configurePCM(outHandle, SND_PCM_STREAM_PLAYBACK, config);
+
+    if (config.linked) snd_pcm_link(inHandle, outHandle);
+    return err;
+}
+
+
+void startDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, const PcmConfig &config){
+    if (config.linked){
+        // fill the playback buffer so it does not underrun before the
+        // first captured period has been processed
+        static const unsigned char silence[SILENCE_BYTES] = {0};
+        snd_pcm_uframes_t frameBytes = config.channels * sampleBytes(config.format);
+        snd_pcm_uframes_t remaining = config.period * config.periods;
+
+        while (remaining > 0){
+            snd_pcm_uframes_t frames = SILENCE_BYTES / frameBytes;
+            if (frames > remaining) frames = remaining;
+            if (pcmWrite(outHandle, silence, frames, config) <= 0) break;
+            remaining -= frames;
+        }
+    }
+
+    // starts playback too when linked
+    snd_pcm_start(inHandle);
+}
+
+
+void stopDuplex(snd_pcm_t* inHandle, snd_pcm_t* outHandle, const PcmConfig &config){
+    snd_pcm_drop(inHandle);
+    snd_pcm_prepare(inHandle);
+    // a linked playback stream follows capture
+    if (!config.linked){
+        snd_pcm_drop(outHandle);
+        snd_pcm_prepare(outHandle);
+    }
+}
+
+
+void pcmPollInit(PcmPoll &pcmPoll, snd_pcm_t* handle){
+    pcmPoll.handle = handle;
+    pcmPoll.count = snd_pcm_poll_descriptors(handle, pcmPoll.fds, PCM_MAX_POLL_FDS);
+}
+
+
+bool pcmPollWait(PcmPoll &pcmPoll, int timeoutMs){
+    if (pcmPoll.count <= 0 || poll(pcmPoll.fds, pcmPoll.count, timeoutMs) <= 0) return false;
+
+    unsigned short revents = 0;
+    snd_pcm_poll_descriptors_revents(pcmPoll.handle, pcmPoll.fds, pcmPoll.count, &revents);
+    return revents & (POLLIN | POLLOUT | POLLERR);
+}
+
+
+// Stream input straight to output for probeMs; returns the number of XRUNs
+static int probeRun(snd_pcm_t* inHandle, snd_pcm_t* outHandle, const PcmConfig &config,
+                    int probeMs){
+    std::vector<unsigned char> block(config.period * config.channels * sampleBytes(config.format));
+
+    // paced by capture, like the streaming loop
+    PcmPoll capture;
+    pcmPollInit(capture, inHandle);
+
+    int xruns = 0;
+    startDuplex(inHandle, outHandle, config);
+
+    std::chrono::steady_clock::time_point end =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(probeMs);
+
+    while (xruns == 0 && std::chrono::steady_clock::now() < end){
+        if (!pcmPollWait(capture, 100)) continue;
+
+        snd_pcm_sframes_t framesRead = pcmRead(inHandle, block.data(), config.period, config);
+        if (framesRead == -EAGAIN) continue;
+        if (framesRead < 0){
+            xruns++;
+            break;
+        }
+
+        if (pcmWrite(outHandle, block.data(), framesRead, config) == -EPIPE)
+            xruns++;
+    }
+
+    stopDuplex(inHandle, outHandle, config);
+    return xruns;
+}
+
+
+int probePeriod(snd_pcm_t* inHandle, snd_pcm_t* outHandle, PcmConfig &config,
+                snd_pcm_uframes_t minPeriod, snd_pcm_uframes_t maxPeriod, int probeMs){
+    for (snd_pcm_uframes_t period = minPeriod; period <= maxPeriod; period *= 2){
+        config.period = period;
+        if (reconfigureDuplex(inHandle, outHandle, config) < 0) continue;
+
+        // the device may have rounded the period up past the next candidate
+        if (config.period > maxPeriod) break;
+
+        int xruns = probeRun(inHandle, outHandle, config, probeMs);
+        if (DEBUG){
+            printf("Probe: period %lu, %d xruns\n", config.period, xruns);
+        }
+        if (xruns == 0) return 0;
+
+        if (config.period > period) period = config.period;
+    }
+
+    config.period = maxPeriod;
+    reconfigureDuplex(inHandle, outHandle, config);
+    return -1;
+}
+
+
+double pcmLatencyMs(const PcmConfig &config){
+    return 1000.0 * config.period * (config.periods + 1) / config.rate;
+}
@@ -0,0 +1,402 @@
+/*
+ * preset.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of preset banks
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "../include/preset.h"
+#include "../include/control.h"
+#include "../include/menu.h"
+
+#define PRESET_LINE 1024        // longest text line
+
+// Menu key of each effect (indexed by EffectType)
+static const char MENU_KEYS[NUM_EFFECTS + 1] = "123456789abcde";
+
+
+PresetBank::~PresetBank(){
+    if (mapping) munmap(mapping, mappingBytes);
+}
+
+
+// Shortest text that reads back as the same float
+static std::string floatText(float value){
+    char text[32];
+    for (int digits = 6; digits < 9; digits++){
+        snprintf(text, sizeof(text), "%.*g", digits, value);
+        if (strtof(text, NULL) == value) return text;
+    }
+    snprintf(text, sizeof(text), "%.9g", value);
+    return text;
+}
+
+
+// A pattern in the form multitapParse reads
+static std::string tapText(const TapPattern &pattern){
+    std::string text;
+    for (int t = 0; t < pattern.count; t++){
+        const TapSetting &tap = pattern.taps[t];
+        if (t > 0) text += ',';
+
+        if (tap.beats == 0.0f)
+            text += floatText(tap.ms);
+        else{
+            // The division as it was written
+            text += floatText(tap.numerator) + '/' + floatText(tap.denominator);
+            if (tap.suffix) text += (char)tap.suffix;
+        }
+        text += ':' + floatText(tap.gain) + ':' + floatText(tap.pan) + ':'
+              + floatText(tap.feedback) + ':' + floatText(tap.damping);
+    }
+    return text;
+}
+
+
+// ---------------------------------------------------------------------------
+// Checks
+// ---------------------------------------------------------------------------
+
+// A record is usable as it is (binary files are not trusted)
+static bool checkPreset(const Preset &preset){
+    if (memchr(preset.name, '\0', PRESET_NAME_SIZE) == NULL || preset.name[0] == '\0') return false;
+    if (memchr(preset.graph, '\0', PRESET_GRAPH_SIZE) == NULL) return false;
+    if (preset.chainLength < -1 || preset.chainLength > EffectChoices::MAX_CHAIN) return false;
+    for (int i = 0; i < preset.chainLength; i++)
+        if (preset.chain[i] < 0 || preset.chain[i] >= NUM_EFFECTS) return false;
+    if (preset.paramMask >> NUM_PARAMS) return false;
+    for (int p = 0; p < NUM_PARAMS; p++)
+        if ((preset.paramMask & (1u << p)) && !std::isfinite(preset.params[p])) return false;
+
+    // Taps must pass the same checks as typed ones
+    if (preset.hasTaps && !multitapValid(preset.taps)) return false;
+
+    if (preset.graph[0] != '\0'){
+        EffectGraph graph;
+        if (graphParse(preset.graph, graph) < 0) return false;
+    }
+    return true;
+}
+
+
+// ---------------------------------------------------------------------------
+// Binary banks
+// ---------------------------------------------------------------------------
+
+static int loadBinary(const char* path, PresetBank &bank){
+    int fd = open(path, O_RDONLY);
+    if (fd < 0){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || (size_t)info.st_size < sizeof(PresetFileHeader)){
+        fprintf(stderr, "Error: %s is not a preset bank\n", path);
+        close(fd);
+        return -1;
+    }
+
+    // Mapped and read in up front, so a switch never waits on the disk
+    size_t bytes = info.st_size;
+    void* mapping = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED){
+        fprintf(stderr, "Error: could not map %s (%s)\n", path, strerror(errno));
+        return -1;
+    }
+
+    const PresetFileHeader &header = *(const PresetFileHeader*)mapping;
+    const char* problem = NULL;
+    if (header.version != PRESET_VERSION) problem = "was written for another version";
+    else if (header.recordSize != sizeof(Preset) || header.params != NUM_PARAMS)
+        problem = "has another record layout";
+    else if (header.count == 0 || header.count > PRESET_MAX) problem = "has no presets, or too many";
+    else if (bytes < sizeof(PresetFileHeader) + header.count * sizeof(Preset)) problem = "is cut short";
+
+    const Preset* presets = (const Preset*)((const char*)mapping + sizeof(PresetFileHeader));
+    for (uint32_t i = 0; !problem && i < header.count; i++)
+        if (!checkPreset(presets[i])) problem = "has an invalid preset";
+
+    if (problem){
+        fprintf(stderr, "Error: preset bank %s %s\n", path, problem);
+        munmap(mapping, bytes);
+        return -1;
+    }
+
+    bank.presets = presets;
+    bank.count = header.count;
+    bank.mapping = mapping;
+    bank.mappingBytes = bytes;
+    return 0;
+}
+
+
+static int saveBinary(const char* path, const PresetBank &bank){
+    FILE* fp = fopen(path, "wb");
+    if (!fp){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+
+    PresetFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, PRESET_MAGIC, sizeof(header.magic));
+    header.version = PRESET_VERSION;
+    header.count = bank.count;
+    header.recordSize = sizeof(Preset);
+    header.params = NUM_PARAMS;
+
+    bool written = fwrite(&header, sizeof(header), 1, fp) == 1
+                   && fwrite(bank.presets, sizeof(Preset), bank.count, fp) == (size_t)bank.count;
+    if (fclose(fp) != 0 || !written){
+        fprintf(stderr, "Error writing %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// Text banks
+// ---------------------------------------------------------------------------
+
+// Apply one "<command> <value>" line to a preset. Returns false (with the
+// reason printed) if it is not valid.
+static bool parseCommand(const std::string &line, Preset &preset){
+    std::istringstream words(line);
+    std::string name, value, extra;
+    words >> name >> value;
+    if (value.empty() || (words >> extra)){
+        fprintf(stderr, "Error: expected \"<command> <value>\"\n");
+        return false;
+    }
+
+    if (name == "chain"){
+        EffectChoices effectChoice;
+        bool validChoice = false;
+        bool exitFlag = false;
+        if (value.find('0') == std::string::npos)
+            chainSelect(value, effectChoice, validChoice, exitFlag);
+        if (!validChoice){
+            fprintf(stderr, "Error: invalid chain %s\n", value.c_str());
+            return false;
+        }
+        for (int i = 0; i < effectChoice.chainLength; i++)
+            preset.chain[i] = effectChoice.chain[i];
+        preset.chainLength = effectChoice.chainLength;
+        return true;
+    }
+
+    if (name == "graph"){
+        EffectGraph graph;
+        if (graphParse(value, graph) < 0) return false;
+        if (value.size() >= PRESET_GRAPH_SIZE){
+            fprintf(stderr, "Error: routing longer than %d characters\n", PRESET_GRAPH_SIZE - 1);
+            return false;
+        }
+        strcpy(preset.graph, value.c_str());
+        return true;
+    }
+
+    if (name == "taps"){
+        if (multitapParse(value, preset.taps) < 0) return false;
+        preset.hasTaps = 1;
+        return true;
+    }
+
+    ParamId param = paramByName(name);
+    char* end = NULL;
+    float number = strtof(value.c_str(), &end);
+    if (param == NUM_PARAMS || *end != '\0'){
+        fprintf(stderr, "Error: unknown command %s %s\n", name.c_str(), value.c_str());
+        return false;
+    }
+    preset.params[param] = number;
+    preset.paramMask |= 1u << param;
+    return true;
+}
+
+
+static int loadText(const char* path, PresetBank &bank){
+    FILE* fp = fopen(path, "r");
+    if (!fp){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+
+    std::vector<Preset> presets;
+    char buffer[PRESET_LINE];
+    int lineNumber = 0;
+    bool ok = true;
+
+    while (ok && fgets(buffer, sizeof(buffer), fp)){
+        lineNumber++;
+        if (!strchr(buffer, '\n') && !feof(fp)){
+            fprintf(stderr, "Error: line longer than %d characters\n", PRESET_LINE - 2);
+            ok = false;
+            break;
+        }
+
+        // Strip comments and surrounding space
+        std::string line = buffer;
+        line = line.substr(0, line.find('#'));
+        size_t first = line.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) continue;
+        line = line.substr(first, line.find_last_not_of(" \t\r\n") - first + 1);
+
+        if (line[0] == '['){
+            std::string name = line.substr(1, line.size() - 2);
+            if (line[line.size() - 1] != ']' || name.empty() || name.size() >= PRESET_NAME_SIZE
+                || name.find_first_of(" \t") != std::string::npos){
+                fprintf(stderr, "Error: preset names are [name], up to %d characters, no spaces\n",
+                        PRESET_NAME_SIZE - 1);
+                ok = false;
+            }
+            for (size_t i = 0; ok && i < presets.size(); i++)
+                if (name == presets[i].name){
+                    fprintf(stderr, "Error: preset %s given twice\n", name.c_str());
+                    ok = false;
+                }
+            if (ok && presets.size() >= PRESET_MAX){
+                fprintf(stderr, "Error: more than %d presets\n", PRESET_MAX);
+                ok = false;
+            }
+            if (!ok) break;
+
+            Preset preset = Preset();
+            strcpy(preset.name, name.c_str());
+            preset.chainLength = -1;
+            presets.push_back(preset);
+        }
+        else if (presets.empty()){
+            fprintf(stderr, "Error: command before the first [name]\n");
+            ok = false;
+        }
+        else
+            ok = parseCommand(line, presets.back());
+    }
+    fclose(fp);
+
+    if (!ok){
+        fprintf(stderr, "  at %s line %d\n", path, lineNumber);
+        return -1;
+    }
+    if (presets.empty()){
+        fprintf(stderr, "Error: no presets in %s\n", path);
+        return -1;
+    }
+
+    bank.parsed.swap(presets);
+    bank.presets = bank.parsed.data();
+    bank.count = (int)bank.parsed.size();
+    return 0;
+}
+
+
+static int saveText(const char* path, const PresetBank &bank){
+    FILE* fp = fopen(path, "w");
+    if (!fp){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+
+    fprintf(fp, "# Preset bank (see preset.h)\n");
+    for (int i = 0; i < bank.count; i++){
+        const Preset &preset = bank.presets[i];
+        fprintf(fp, "\n[%s]\n", preset.name);
+
+        if (preset.chainLength >= 0){
+            fprintf(fp, "chain ");
+            for (int c = 0; c < preset.chainLength; c++)
+                fputc(MENU_KEYS[preset.chain[c]], fp);
+            fputc('\n', fp);
+        }
+        if (preset.graph[0] != '\0')
+            fprintf(fp, "graph %s\n", preset.graph);
+
+        if (preset.hasTaps)
+            fprintf(fp, "taps %s\n", tapText(preset.taps).c_str());
+
+        for (int p = 0; p < NUM_PARAMS; p++)
+            if (preset.paramMask & (1u << p))
+                fprintf(fp, "%s %s\n", paramName((ParamId)p), floatText(preset.params[p]).c_str());
+    }
+
+    if (fclose(fp) != 0){
+        fprintf(stderr, "Error writing %s\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+
+// ---------------------------------------------------------------------------
+// Control side
+// ---------------------------------------------------------------------------
+
+int presetLoadBank(const char* path, PresetBank &bank){
+    if (bank.count > 0){
+        fprintf(stderr, "Error: a preset bank is already loaded\n");
+        return -1;
+    }
+
+    FILE* fp = fopen(path, "rb");
+    if (!fp){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+    char magic[8] = {};
+    size_t got = fread(magic, 1, sizeof(magic), fp);
+    fclose(fp);
+
+    if (got == sizeof(magic) && memcmp(magic, PRESET_MAGIC, sizeof(magic)) == 0)
+        return loadBinary(path, bank);
+    return loadText(path, bank);
+}
+
+
+int presetSaveBank(const char* path, const PresetBank &bank){
+    size_t len = strlen(path);
+    bool text = len >= 4 && strcmp(path + len - 4, ".txt") == 0;
+    return text ? saveText(path, bank) : saveBinary(path, bank);
+}
+
+
+const Preset* presetFind(const PresetBank &bank, const std::string &name){
+    for (int i = 0; i < bank.count; i++)
+        if (name == bank.presets[i].name) return &bank.presets[i];
+    return NULL;
+}
+
+
+void presetApply(const Preset &preset, AudioParams &audioParams, EffectChoices &effectChoice){
+    for (int p = 0; p < NUM_PARAMS; p++)
+        if (preset.paramMask & (1u << p))
+            paramSet(audioParams, (ParamId)p, preset.params[p]);
+    if (preset.hasTaps) audioParams.TAPS = preset.taps;
+
+    if (preset.chainLength >= 0){
+        std::string keys;
+        for (int i = 0; i < preset.chainLength; i++)
+            keys += MENU_KEYS[preset.chain[i]];
+
+        bool validChoice = false;
+        bool exitFlag = false;
+        effectChoice = EffectChoices();
+        chainSelect(keys, effectChoice, validChoice, exitFlag);
+    }
+}
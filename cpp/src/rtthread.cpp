@@ -0,0 +1,119 @@
+/*
+ * rtthread.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of real-time thread helpers
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <sched.h>
+#include <unistd.h>
+#include <climits>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#include "../include/rtthread.h"
+
+#define PREFAULT_STACK_BYTES (256 * 1024)
+
+
+int lockMemory(){
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0){
+        fprintf(stderr, "Warning: mlockall failed (%s), memory may be paged\n", strerror(errno));
+        return -errno;
+    }
+    return 0;
+}
+
+
+void prefaultBuffer(void* buffer, size_t bytes){
+    long page = sysconf(_SC_PAGESIZE);
+    if (page <= 0) page = 4096;
+
+    volatile unsigned char* p = (volatile unsigned char*)buffer;
+    for (size_t i = 0; i < bytes; i += page)
+        p[i] = p[i];
+}
+
+
+void prefaultStack(){
+    unsigned char stack[PREFAULT_STACK_BYTES];
+    memset(stack, 0, sizeof(stack));
+    prefaultBuffer(stack, sizeof(stack));
+}
+
+
+void futexWait(std::atomic<uint32_t> &word, uint32_t seen){
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, seen, NULL, NULL, 0);
+#else
+    (void)word; (void)seen;
+    sched_yield();
+#endif
+}
+
+
+void futexWakeAll(std::atomic<uint32_t> &word){
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#else
+    (void)word;
+#endif
+}
+
+
+// Create the thread with the given attributes
+static int createThread(pthread_t* thread, const RtThreadConfig &config, bool realtime,
+                        void* (*function)(void*), void* arg){
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+
+    if (realtime){
+        struct sched_param param;
+        memset(&param, 0, sizeof(param));
+        param.sched_priority = config.priority;
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &param);
+    }
+
+#ifdef __linux__
+    if (config.cpu >= 0){
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(config.cpu, &cpus);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus);
+    }
+#endif
+
+    int err = pthread_create(thread, &attr, function, arg);
+    pthread_attr_destroy(&attr);
+    return err;
+}
+
+
+int startRtThread(pthread_t* thread, const RtThreadConfig &config,
+                  void* (*function)(void*), void* arg){
+    if (config.lockMemory)
+        lockMemory();
+
+    bool realtime = config.priority > 0;
+    int err = createThread(thread, config, realtime, function, arg);
+
+    if (err == EPERM && realtime){
+        fprintf(stderr, "Warning: no permission for SCHED_FIFO priority %d, "
+                        "running audio thread with normal scheduling\n", config.priority);
+        err = createThread(thread, config, false, function, arg);
+    }
+
+    if (err != 0)
+        fprintf(stderr, "Error starting audio thread: %s\n", strerror(err));
+    return -err;
+}
@@ -0,0 +1,106 @@
+/*
+ * shaper.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of the waveshaper tables
+*/
+
+#include <cmath>
+#include "../include/shaper.h"
+
+#define SHAPER_MIN_DIVISOR 1e-6f    // keeps the fuzz normalization finite at bias = +-1
+
+
+// 1 / normalization, keeping the sign of the divisor
+static float inverseNormalize(float a, float edge){
+    float divisor = edge;
+    if (fabsf(divisor) < SHAPER_MIN_DIVISOR) divisor = divisor < 0.0f ? -SHAPER_MIN_DIVISOR : SHAPER_MIN_DIVISOR;
+    return (a + fabsf(edge)) / divisor;
+}
+
+
+// Sample the curve (and the fuzz normalization) for one setting
+static void buildTables(Waveshaper &w, ShaperId id, const ShaperSettings &settings){
+    w.a = 1 / (settings.factor * settings.drive + 0.01);
+
+    if (id == SHAPER_OD){
+        w.scale = w.a + 1;
+        w.bias = 0.0f;
+        w.range = 2.0f;
+    }
+    else{
+        w.scale = 1.0f;
+        w.bias = settings.maxBias * settings.drive;
+        w.range = 2.0f + fabsf(w.bias);
+    }
+    w.toIndex = SHAPER_SIZE / (2.0f * w.range);
+
+    for (int i = 0; i <= SHAPER_SIZE; i++){
+        float x = -w.range + 2.0f * w.range * i / SHAPER_SIZE;
+        w.curve[i] = x / (w.a + fabsf(x)) * w.scale;
+    }
+
+    // Normalization of the positive and negative half at each envelope level
+    for (int i = 0; i <= SHAPER_ENV_SIZE; i++){
+        float bias = w.bias * i / SHAPER_ENV_SIZE;
+        w.posScale[i] = inverseNormalize(w.a, 1 + bias);
+        w.negScale[i] = inverseNormalize(w.a, 1 - bias);
+    }
+    w.posScale[SHAPER_ENV_SIZE + 1] = w.posScale[SHAPER_ENV_SIZE];
+    w.negScale[SHAPER_ENV_SIZE + 1] = w.negScale[SHAPER_ENV_SIZE];
+}
+
+
+void shaperInit(ShaperBank &bank, ShaperId id, const ShaperSettings &settings){
+    bank.settings = settings;
+    buildTables(bank.slots[0], id, settings);
+
+    slotReset(bank.pool, 0);
+    bank.current = 0;
+    bank.previous = -1;
+    bank.fadeRemaining = 0;
+    bank.fade = 1.0f;
+}
+
+
+int shaperBuild(ShaperBank &bank, ShaperId id, const ShaperSettings &settings){
+    int slot = slotAcquire(bank.pool);
+    if (slot < 0) return -1;
+
+    buildTables(bank.slots[slot], id, settings);
+    bank.settings = settings;
+    return slot;
+}
+
+
+void shaperSwitch(ShaperBank &bank, int slot, int fadeFrames){
+    // A switch during a crossfade drops the oldest table
+    if (bank.previous >= 0) slotRelease(bank.pool, bank.previous);
+
+    bank.previous = bank.current;
+    bank.current = slot;
+
+    if (fadeFrames < 1) fadeFrames = 1;
+    bank.fadeRemaining = fadeFrames;
+    bank.fadeStep = 1.0f / fadeFrames;
+    bank.fade = 0.0f;
+}
+
+
+void shaperAdvance(ShaperBank &bank, unsigned long frames){
+    if (bank.previous < 0) return;
+
+    if ((unsigned long)bank.fadeRemaining <= frames){
+        slotRelease(bank.pool, bank.previous);
+        bank.previous = -1;
+        bank.fadeRemaining = 0;
+        bank.fade = 1.0f;
+    }
+    else{
+        bank.fadeRemaining -= frames;
+        bank.fade += bank.fadeStep * frames;
+    }
+}
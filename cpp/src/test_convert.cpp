@@ -0,0 +1,130 @@
+/*
+ * test_convert.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Checks every S16 <-> float kernel set the CPU can run
+ * (convert.h), not only the one picked at startup, bit exact against the
+ * scalar versions, for 1-8 channels, odd frame counts and inputs that
+ * saturate. Run with "make test"; returns 0 if all passed.
+*/
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "../include/convert.h"
+
+#define MAX_TEST_FRAMES 1031        // odd, so every kernel has a tail
+
+// Frame counts around the SIMD widths (4, 8 and 16 samples)
+static const unsigned long FRAME_COUNTS[] = {1, 2, 3, 5, 7, 8, 9, 15, 16, 17, 31, 33, 255, 513, MAX_TEST_FRAMES};
+static const int NUM_FRAME_COUNTS = sizeof(FRAME_COUNTS) / sizeof(FRAME_COUNTS[0]);
+
+// Floats that hit the clamp and the truncation edges
+static const float EDGES[] = {
+    0.0f, -0.0f, 1.0f, -1.0f, 1.0001f, -1.0001f, 2.0f, -2.0f, 1e9f, -1e9f, 1e30f, -1e30f,
+    0.5f / 32767.0f, -0.5f / 32767.0f, 1.0f / 32767.0f, -1.0f / 32767.0f,
+    32766.5f / 32767.0f, -32766.5f / 32767.0f, 0.99999994f, -0.99999994f, 1e-40f, -1e-40f
+};
+static const int NUM_EDGES = sizeof(EDGES) / sizeof(EDGES[0]);
+
+static uint32_t randomState = 12345;
+
+static uint32_t nextRandom(){
+    randomState = randomState * 1664525u + 1013904223u;
+    return randomState;
+}
+
+
+// S16 -> float for every channel count and frame count
+static int testDeinterleave(const ConvertKernels &kernels){
+    int failures = 0;
+    std::vector<SAMPLE> in(MAX_TEST_FRAMES * AudioParams::MAX_CHANNELS);
+    std::vector<float> fast(MAX_TEST_FRAMES * AudioParams::MAX_CHANNELS);
+    std::vector<float> reference(fast.size());
+
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = (SAMPLE)(nextRandom() >> 16);
+    in[0] = -32768;
+    in[1] = 32767;
+
+    for (int channels = 1; channels <= AudioParams::MAX_CHANNELS; channels++)
+        for (int f = 0; f < NUM_FRAME_COUNTS; f++){
+            const unsigned long frames = FRAME_COUNTS[f];
+            float* fastOut[AudioParams::MAX_CHANNELS];
+            float* referenceOut[AudioParams::MAX_CHANNELS];
+            for (int ch = 0; ch < channels; ch++){
+                fastOut[ch] = fast.data() + ch * MAX_TEST_FRAMES;
+                referenceOut[ch] = reference.data() + ch * MAX_TEST_FRAMES;
+            }
+
+            kernels.toFloat(in.data(), fastOut, frames, channels);
+            deinterleaveToFloatScalar(in.data(), referenceOut, frames, channels);
+
+            for (int ch = 0; ch < channels; ch++)
+                if (memcmp(fastOut[ch], referenceOut[ch], frames * sizeof(float)) != 0){
+                    fprintf(stderr, "FAIL %s deinterleave: %d channels, %lu frames, channel %d\n",
+                            kernels.name, channels, frames, ch);
+                    failures++;
+                }
+        }
+    return failures;
+}
+
+
+// float -> S16 for every channel count and frame count, with saturation
+static int testInterleave(const ConvertKernels &kernels){
+    int failures = 0;
+    std::vector<float> in(MAX_TEST_FRAMES * AudioParams::MAX_CHANNELS);
+    std::vector<SAMPLE> fast(MAX_TEST_FRAMES * AudioParams::MAX_CHANNELS);
+    std::vector<SAMPLE> reference(fast.size());
+
+    // Mostly [-1.5, 1.5] so a third of the samples clamp, with the edges spread through
+    for (size_t i = 0; i < in.size(); i++)
+        in[i] = (nextRandom() >> 8) * (3.0f / 16777216.0f) - 1.5f;
+    for (size_t i = 0; i < in.size(); i += 7)
+        in[i] = EDGES[(i / 7) % NUM_EDGES];
+
+    for (int channels = 1; channels <= AudioParams::MAX_CHANNELS; channels++)
+        for (int f = 0; f < NUM_FRAME_COUNTS; f++){
+            const unsigned long frames = FRAME_COUNTS[f];
+            const float* buffers[AudioParams::MAX_CHANNELS];
+            for (int ch = 0; ch < channels; ch++)
+                buffers[ch] = in.data() + ch * MAX_TEST_FRAMES;
+
+            kernels.toSample(buffers, fast.data(), frames, channels);
+            interleaveToSampleScalar(buffers, reference.data(), frames, channels);
+
+            if (memcmp(fast.data(), reference.data(), frames * channels * sizeof(SAMPLE)) != 0){
+                fprintf(stderr, "FAIL %s interleave: %d channels, %lu frames\n",
+                        kernels.name, channels, frames);
+                failures++;
+            }
+        }
+    return failures;
+}
+
+
+int main(){
+    printf("Conversion kernels: %s (selected)", convertKernelName());
+    for (int k = 1; k < convertKernelCount(); k++) printf(", %s", convertKernel(k).name);
+    printf("\n");
+
+    // The same inputs for every set (the random state restarts)
+    int failures = 0;
+    for (int k = 0; k < convertKernelCount(); k++){
+        randomState = 12345;
+        failures += testDeinterleave(convertKernel(k)) + testInterleave(convertKernel(k));
+    }
+    if (failures > 0){
+        fprintf(stderr, "%d conversion checks failed\n", failures);
+        return 1;
+    }
+
+    printf("All conversion checks passed (%d kernel sets, 1-%d channels, %d frame counts)\n",
+           convertKernelCount(), AudioParams::MAX_CHANNELS, NUM_FRAME_COUNTS);
+    return 0;
+}
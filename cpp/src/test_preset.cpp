@@ -0,0 +1,110 @@
+/*
+ * test_preset.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Checks that a preset bank survives text -> binary -> text
+ * unchanged, with taps at the edges of what multitapParse accepts (whole
+ * notes, 1/128 triplets, dotted notes, ms). Run with "make test"; returns
+ * 0 if all passed.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "../include/preset.h"
+
+static const char* BANK_TEXT =
+    "[edges]\n"
+    "chain 3e\n"
+    "taps 32/1:0.5,1/128t:0.5:0:0.2:0.5,64/128.:0.4:-1,1/1t,4000:0.2\n"
+    "mix 0.35\n"
+    "\n"
+    "[routing]\n"
+    "graph 6[|3:0.5|4:0.5]\n"
+    "taps 1/4:0.8:-0.5:0.3,1/8.:0.6:0.5,375\n"
+    "tap_bpm 97.5\n";
+
+static int failures = 0;
+
+static void check(bool passed, const char* what){
+    if (!passed){
+        fprintf(stderr, "FAIL %s\n", what);
+        failures++;
+    }
+}
+
+// Whole file as a string ("" if it cannot be read)
+static std::string readFile(const std::string &path){
+    std::string text;
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) return text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) text.append(buffer, n);
+    fclose(fp);
+    return text;
+}
+
+// Two banks hold the same presets
+static bool sameBank(const PresetBank &a, const PresetBank &b){
+    if (a.count != b.count) return false;
+    for (int i = 0; i < a.count; i++){
+        const Preset &x = a.presets[i], &y = b.presets[i];
+        if (strcmp(x.name, y.name) != 0 || strcmp(x.graph, y.graph) != 0) return false;
+        if (x.chainLength != y.chainLength || x.paramMask != y.paramMask || x.hasTaps != y.hasTaps) return false;
+        if (memcmp(x.chain, y.chain, sizeof(x.chain)) != 0) return false;
+        if (memcmp(x.params, y.params, sizeof(x.params)) != 0) return false;
+        if (memcmp(&x.taps, &y.taps, sizeof(x.taps)) != 0) return false;
+    }
+    return true;
+}
+
+
+int main(){
+    char dir[] = "/tmp/test_preset_XXXXXX";
+    if (!mkdtemp(dir)){
+        fprintf(stderr, "Error: no temporary directory\n");
+        return 1;
+    }
+    const std::string text = std::string(dir) + "/bank.txt";
+    const std::string binary = std::string(dir) + "/bank.bin";
+    const std::string again = std::string(dir) + "/again.txt";
+
+    FILE* fp = fopen(text.c_str(), "w");
+    if (!fp) return 1;
+    fputs(BANK_TEXT, fp);
+    fclose(fp);
+
+    PresetBank fromText, fromBinary, fromAgain;
+    check(presetLoadBank(text.c_str(), fromText) == 0, "load text");
+    check(fromText.count == 2, "two presets");
+    check(presetSaveBank(binary.c_str(), fromText) == 0, "save binary");
+    check(presetLoadBank(binary.c_str(), fromBinary) == 0, "load binary");
+    check(sameBank(fromText, fromBinary), "binary holds the text bank");
+
+    check(presetSaveBank(again.c_str(), fromBinary) == 0, "save text");
+    check(presetLoadBank(again.c_str(), fromAgain) == 0, "load saved text");
+    check(sameBank(fromText, fromAgain), "saved text holds the text bank");
+
+    // Taps are written as they were typed
+    std::string saved = readFile(again);
+    check(saved.find("taps 32/1:0.5:0:0:0,1/128t:0.5:0:0.2:0.5,64/128.:0.4:-1:0:0,1/1t:1:0:0:0,4000:0.2:0:0:0\n")
+          != std::string::npos, "division taps written as typed");
+
+    unlink(text.c_str());
+    unlink(binary.c_str());
+    unlink(again.c_str());
+    rmdir(dir);
+
+    if (failures > 0){
+        fprintf(stderr, "%d preset checks failed\n", failures);
+        return 1;
+    }
+    printf("All preset checks passed (text -> binary -> text)\n");
+    return 0;
+}
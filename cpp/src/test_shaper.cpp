@@ -0,0 +1,135 @@
+/*
+ * test_shaper.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Checks the waveshaper tables (shaper.h) against the curve
+ * computed directly. Renders overdrive and fuzz through the render tool
+ * built with SHAPER_TABLES=0 and with SHAPER_TABLES=1 and compares the two
+ * outputs sample by sample. Run with "make test"; returns 0 if all passed.
+ *
+ * Usage: ./test_shaper <render without tables> <render with tables>
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include "../include/wavfile.h"
+
+#define TEST_SECONDS 2
+#define TEST_RATE    44100
+
+// Largest difference allowed, in S16 steps. Linear interpolation over
+// SHAPER_SIZE intervals stays within a few steps at these settings (fuzz
+// multiplies two interpolated tables); a curve 1% off is off by over 100.
+#define SHAPER_TOLERANCE 16
+
+// Effects and oversampling rendered with both builds
+struct ShaperCase{
+    const char* effects;
+    const char* oversample;
+};
+
+static const ShaperCase CASES[] = {
+    {"6",  "2"},        // overdrive
+    {"6",  "8"},
+    {"8",  "2"},        // fuzz
+    {"8",  "8"},
+    {"68", "4"},        // overdrive -> fuzz
+};
+static const int NUM_CASES = sizeof(CASES) / sizeof(CASES[0]);
+
+
+// Two tones swelling from silence to full scale and back, a little louder
+// on the right, so the whole curve and the fuzz envelope get used
+static void makeInput(AudioFile &file){
+    const int frames = TEST_SECONDS * TEST_RATE;
+    file.channels = 2;
+    file.sampleRate = TEST_RATE;
+    file.isWav = true;
+    file.samples.resize(frames * 2);
+
+    for (int i = 0; i < frames; i++){
+        float t = (float)i / TEST_RATE;
+        float swell = sinf((float)M_PI * i / frames);
+        float tone = 0.7f * sinf(2.0f * (float)M_PI * 220.0f * t) + 0.3f * sinf(2.0f * (float)M_PI * 1130.0f * t);
+        file.samples[2 * i]     = (SAMPLE)(32767.0f * 0.9f * swell * tone);
+        file.samples[2 * i + 1] = (SAMPLE)(32767.0f * swell * tone);
+    }
+}
+
+// Render one case; returns 0 on success
+static int render(const char* tool, const ShaperCase &c, const std::string &in, const std::string &out){
+    std::string command = std::string(tool) + " --oversample " + c.oversample + " " + c.effects
+                        + " " + in + " " + out + " > /dev/null";
+    return system(command.c_str());
+}
+
+// Largest difference between two renders (-1 if they cannot be compared)
+static int maxDifference(const AudioFile &a, const AudioFile &b){
+    if (a.samples.size() != b.samples.size() || a.channels != b.channels) return -1;
+
+    int largest = 0;
+    for (size_t i = 0; i < a.samples.size(); i++){
+        int difference = abs((int)a.samples[i] - (int)b.samples[i]);
+        if (difference > largest) largest = difference;
+    }
+    return largest;
+}
+
+
+int main(int argc, char** argv){
+    if (argc != 3){
+        fprintf(stderr, "Usage: %s <render without tables> <render with tables>\n", argv[0]);
+        return 1;
+    }
+
+    char dir[] = "/tmp/test_shaper_XXXXXX";
+    if (!mkdtemp(dir)){
+        fprintf(stderr, "Error: no temporary directory\n");
+        return 1;
+    }
+    const std::string input = std::string(dir) + "/in.wav";
+    const std::string direct = std::string(dir) + "/direct.wav";
+    const std::string tables = std::string(dir) + "/tables.wav";
+
+    AudioFile source;
+    makeInput(source);
+    if (writeAudioFile(input.c_str(), source) < 0) return 1;
+
+    int failures = 0;
+    for (int i = 0; i < NUM_CASES; i++){
+        const ShaperCase &c = CASES[i];
+        AudioFile a, b;
+        if (render(argv[1], c, input, direct) != 0 || render(argv[2], c, input, tables) != 0
+            || readAudioFile(direct.c_str(), a) < 0 || readAudioFile(tables.c_str(), b) < 0){
+            fprintf(stderr, "FAIL %s (oversample %s): render failed\n", c.effects, c.oversample);
+            failures++;
+            continue;
+        }
+
+        int difference = maxDifference(a, b);
+        if (difference < 0 || difference > SHAPER_TOLERANCE){
+            fprintf(stderr, "FAIL %s (oversample %s): tables differ by %d (allowed %d)\n",
+                    c.effects, c.oversample, difference, SHAPER_TOLERANCE);
+            failures++;
+        }
+    }
+
+    unlink(input.c_str());
+    unlink(direct.c_str());
+    unlink(tables.c_str());
+    rmdir(dir);
+
+    if (failures > 0){
+        fprintf(stderr, "%d waveshaper checks failed\n", failures);
+        return 1;
+    }
+    printf("All waveshaper checks passed (%d renders within %d steps of the direct curve)\n",
+           NUM_CASES, SHAPER_TOLERANCE);
+    return 0;
+}
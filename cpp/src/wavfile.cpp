@@ -0,0 +1,162 @@
+/*
+ * wavfile.cpp
+ * DSP Program
+ *
+ * Tiffany Liu
+ * 17 October 2026
+ *
+ * Description: Implementation of WAV / raw S16 file input and output
+*/
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include "../include/wavfile.h"
+
+// Little endian helpers (WAV is always little endian)
+static uint32_t readLE32(const unsigned char* p){
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t readLE16(const unsigned char* p){
+    return p[0] | (p[1] << 8);
+}
+
+static void writeLE32(unsigned char* p, uint32_t v){
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff; p[2] = (v >> 16) & 0xff; p[3] = (v >> 24) & 0xff;
+}
+
+static void writeLE16(unsigned char* p, uint16_t v){
+    p[0] = v & 0xff; p[1] = (v >> 8) & 0xff;
+}
+
+
+bool isWavPath(const char* path){
+    size_t len = strlen(path);
+    if (len < 4) return false;
+    const char* ext = path + len - 4;
+    return ext[0] == '.' && tolower(ext[1]) == 'w' && tolower(ext[2]) == 'a' && tolower(ext[3]) == 'v';
+}
+
+
+// Read raw little endian S16 samples into the file buffer
+static int readSamples(FILE* fp, AudioFile &file, size_t bytes){
+    std::vector<unsigned char> raw(bytes);
+    size_t got = fread(raw.data(), 1, bytes, fp);
+    size_t count = got / 2;
+    count -= count % file.channels;     // drop trailing partial frame
+
+    file.samples.resize(count);
+    for (size_t i = 0; i < count; i++)
+        file.samples[i] = (SAMPLE)readLE16(&raw[2 * i]);
+    return 0;
+}
+
+
+int readAudioFile(const char* path, AudioFile &file){
+    FILE* fp = fopen(path, "rb");
+    if (!fp){
+        fprintf(stderr, "Error opening %s\n", path);
+        return -1;
+    }
+
+    file.isWav = isWavPath(path);
+
+    // Raw S16_LE: read everything
+    if (!file.isWav){
+        fseek(fp, 0, SEEK_END);
+        long size = ftell(fp);
+        fseek(fp, 0, SEEK_SET);
+        int err = readSamples(fp, file, size > 0 ? size : 0);
+        fclose(fp);
+        return err;
+    }
+
+    unsigned char header[12];
+    if (fread(header, 1, 12, fp) != 12 || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)){
+        fprintf(stderr, "Error: %s is not a RIFF/WAVE file\n", path);
+        fclose(fp);
+        return -1;
+    }
+
+    // Walk chunks until "data", picking up "fmt " on the way
+    bool haveFormat = false;
+    unsigned char chunk[8];
+    while (fread(chunk, 1, 8, fp) == 8){
+        uint32_t size = readLE32(chunk + 4);
+
+        if (!memcmp(chunk, "fmt ", 4)){
+            unsigned char fmt[40] = {};
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (size < 16 || fread(fmt, 1, want, fp) != want) break;
+            fseek(fp, size - want + (size & 1), SEEK_CUR);
+
+            uint16_t tag  = readLE16(fmt);
+            uint16_t bits = readLE16(fmt + 14);
+            if (tag == 0xFFFE && size >= 26)        // WAVE_FORMAT_EXTENSIBLE
+                tag = readLE16(fmt + 24);
+            if (tag != 1 || bits != 16){
+                fprintf(stderr, "Error: %s must be 16-bit PCM\n", path);
+                fclose(fp);
+                return -1;
+            }
+            file.channels   = readLE16(fmt + 2);
+            file.sampleRate = readLE32(fmt + 4);
+            haveFormat = true;
+        }
+        else if (!memcmp(chunk, "data", 4)){
+            if (!haveFormat || file.channels < 1) break;
+            int err = readSamples(fp, file, size);
+            fclose(fp);
+            return err;
+        }
+        else{
+            fseek(fp, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fprintf(stderr, "Error: %s has no usable fmt/data chunks\n", path);
+    fclose(fp);
+    return -1;
+}
+
+
+int writeAudioFile(const char* path, const AudioFile &file){
+    FILE* fp = fopen(path, "wb");
+    if (!fp){
+        fprintf(stderr, "Error opening %s for writing\n", path);
+        return -1;
+    }
+
+    uint32_t dataBytes = file.samples.size() * 2;
+
+    if (file.isWav){
+        unsigned char header[44];
+        memcpy(header, "RIFF", 4);
+        writeLE32(header + 4, 36 + dataBytes);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        writeLE32(header + 16, 16);
+        writeLE16(header + 20, 1);                                      // PCM
+        writeLE16(header + 22, file.channels);
+        writeLE32(header + 24, file.sampleRate);
+        writeLE32(header + 28, file.sampleRate * file.channels * 2);    // byte rate
+        writeLE16(header + 32, file.channels * 2);                      // block align
+        writeLE16(header + 34, 16);
+        memcpy(header + 36, "data", 4);
+        writeLE32(header + 40, dataBytes);
+        fwrite(header, 1, sizeof(header), fp);
+    }
+
+    std::vector<unsigned char> raw(dataBytes);
+    for (size_t i = 0; i < file.samples.size(); i++)
+        writeLE16(&raw[2 * i], (uint16_t)file.samples[i]);
+    size_t written = fwrite(raw.data(), 1, raw.size(), fp);
+    fclose(fp);
+
+    if (written != raw.size()){
+        fprintf(stderr, "Error writing %s\n", path);
+        return -1;
+    }
+    return 0;
+}